@@ -85,7 +85,6 @@ int main(int argc, char *argv[])
 
   int retval;
   string cmd;
-  string gennPath = getenv("GENN_PATH");
   string modelName = "ALmodel";
 
   int which = atoi(argv[1]);
@@ -93,17 +92,31 @@ int main(int argc, char *argv[])
   string basename= argv[3];
   int dbgMode= atoi(argv[4]);
 
-  // write info in file
-  ofstream infoOs("model/settings.h");
-  const char *path= getenv ("PWD");
-  infoOs << "const char* INPUTFILE =\"" << path << "/" << outdir << "/" << basename << ".in\";" << endl;
-  if (which > 1) {
+  // write info in file; the CPU build reads <outdir>/<basename>.in at runtime and does not use it
+  if (which > 0) {
+    ofstream infoOs("model/settings.h");
+    const char *path= getenv ("PWD");
+    infoOs << "const char* INPUTFILE =\"" << path << "/" << outdir << "/" << basename << ".in\";" << endl;
+    if (which > 1) {
       infoOs << "#define nGPU " << which-2 << endl;
       which= 1;
+    }
+    infoOs.close();
   }
-  infoOs.close();
 
   // build it
+  if (which == 0) {
+    // CPU: use the standalone CPU engine, no GeNN code generation or CUDA needed;
+    // it is only rebuilt when its sources change
+    cmd = "cd model && make CPU_ONLY=1";
+    if (dbgMode == 1) {
+      cmd += " debug";
+    }
+    else {
+      cmd += " release";
+    }
+  }
+  else {
 #ifdef _WIN32
   cmd = "cd model && buildmodel.bat " + modelName + " " + toString(dbgMode);
   cmd += " && nmake /nologo /f WINmakefile clean && nmake /nologo /f WINmakefile";
@@ -120,6 +133,7 @@ int main(int argc, char *argv[])
     cmd += " release";
   }
 #endif
+  }
   cerr << cmd << endl;
   retval=system(cmd.c_str());
   if (retval != 0){
@@ -137,7 +151,10 @@ int main(int argc, char *argv[])
     cmd = "model\\ALsim.exe " + outdir + " " + basename + " " + toString(which);
   }
 #else // UNIX
-  if (dbgMode == 1) {
+  if ((dbgMode == 1) && (which == 0)) {
+    cmd = "gdb -tui --args model/ALsim "+ outdir + " " + basename + " " + toString(which);
+  }
+  else if (dbgMode == 1) {
     cmd = "cuda-gdb -tui --args model/ALsim_sim "+ outdir + " " + basename + " " + toString(which);
   }
   else {
@@ -18,6 +18,8 @@
 
 
 #include <cassert>
+#include <cstring>
+#include "philox.h"
 
 AL::AL(unsigned int which)
 {
@@ -31,6 +33,9 @@ AL::AL(unsigned int which)
   reward= 0.0;
   RORNPN1= base_RORNPN1;
   RORN= RORNPN1;
+#ifdef CPU_ONLY
+  rewardChangedCPU(base_RORNPN1+reward);
+#endif
   enabled= 0;
 }
 
@@ -43,168 +48,340 @@ AL::~AL()
 
 void AL::enable()
 {
+#ifndef CPU_ONLY
     copyStateToDevice();
+#endif
     initializeAllSparseArrays();
     initialize_input();
     enabled= 1;
 }
 
+//--------------------------------------------------------------------------
+/*! \brief Set up the odors of odorPath.
+
+  odorPath is either a directory of odor<i><odorExt> text files or an odor
+  bank made by tools/odor2odb, which is mapped into memory. In both cases
+  an odor is only read when it is first used (see load_odors()).
+ */
+//--------------------------------------------------------------------------
+
 void AL::readOdors(int _nOdorin, string odorPath, string odorExt) 
 {
 #ifdef DEBUG
   cerr << "# entering readOdors in " << odorPath << endl;
 #endif
-  vector<double> pp(6);
-  vector<vector<double> > gloPP;
-
-  string name;
+  struct stat st;
+  if ((stat(odorPath.c_str(), &st) == 0) && S_ISREG(st.st_mode)) {
+    if (!bank.open(odorPath)) {
+      cerr << odorPath << " is not an odor bank ... exiting" << endl;
+      exit(1);
+    }
+    if ((bank.gloN != (unsigned int) _nGLO) || (bank.paraN != 5)) {
+      cerr << "odor bank " << odorPath << " has " << bank.gloN << " glomeruli with " << bank.paraN << " parameters, expected " << _nGLO << " with 5 ... exiting" << endl;
+      exit(1);
+    }
+    if ((int) bank.odorN != _nOdorin) {
+      cerr << "% odor bank " << odorPath << " holds " << bank.odorN << " odors, _nOdor= " << _nOdorin << " is replaced" << endl;
+    }
+    _nOdor= bank.odorN;
+    return;
+  }
   _nOdor= _nOdorin;
-  for (int i= 0; i < _nOdor; i++) {
-    name= odorPath + toString("/odor") + toString(i) + odorExt;
-    ifstream is(name.c_str());
-    if (!is.good()) {
+  odorDir= odorPath;
+  this->odorExt= odorExt;
+  odorPP.assign(_nOdor*_nGLO*5, 0.0);
+  odorRead.assign(_nOdor, 0);
+}
+
+// the _nGLO*5 parameters of odor od; a text odor is read here on first use
+const double *AL::odor(unsigned int od)
+{
+  if (od >= (unsigned int) _nOdor) {
+    cerr << "odor " << od << " does not exist, there are " << _nOdor << " ... exiting" << endl;
+    exit(1);
+  }
+  if (bank.is_open()) return bank.odor(od);
+  double *pp= &odorPP[od*_nGLO*5];
+  if (!odorRead[od]) {
+    string name= odorDir + toString("/odor") + toString(od) + odorExt;
+    if (!readOdorFile(name, _nGLO, 5, pp)) {
       cerr << name << " not found ... exiting" << endl;
       exit(1);
     }
-    for (int j= 0; j < _nGLO; j++) {
-      for (int k= 0; k < 5; k++) {
-	is >> pp[k];
-      }
-      gloPP.push_back(pp);
-    }
+    odorRead[od]= 1;
 #ifdef DEBUG
-    cerr << "# odor " << i << " starts with" << endl;
+    cerr << "# odor " << od << " starts with" << endl;
     for (int k= 0; k < 5; k++) {
-	cerr << gloPP[0][k] << " ";
+	cerr << pp[k] << " ";
     }
     cerr << endl;
 #endif
-    odorPP.push_back(gloPP);
-    gloPP.clear();
   }
-#ifdef DEBUG
-    cerr << "# odors read successfully ... " << endl;
+  return pp;
+}
+
+// read (or page in) the odors that protocol p applies, and only those
+void AL::load_odors(const vector<proto_item> &p)
+{
+  for (unsigned int i= 0; i < p.size(); i++) {
+    if (p[i].op == PROTO_ODOR_ON) {
+      odor(p[i].value[1].i);
+      if (bank.is_open()) bank.willNeed(p[i].value[1].i);
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Take synapse group name from connFile instead of building it.
+
+  Returns false if connFile is not set or does not hold the group, which
+  must have preN rows and postN columns. The CPU build uses the arrays of
+  the mapped file where they are, unless copy is set or the file holds
+  the other floating point type; the GPU build copies them into the
+  arrays of allocate.
+ */
+//--------------------------------------------------------------------------
+
+bool AL::conn_group(const char *name, SparseProjection &C, scalar *&g, unsigned int preN, unsigned int postN, void (*allocate)(unsigned int), bool copy)
+{
+  if (connFile == "") return false;
+  if (!conn.is_open() && !conn.open(connFile)) {
+    cerr << connFile << " is not a connectivity file ... exiting" << endl;
+    exit(1);
+  }
+  const conEntry *e= conn.find(name);
+  if (e == NULL) return false;
+  if ((e->kind != CONBIN_CSR) || (e->rows != preN) || (e->cols != postN) || !conn.checkCSR(e)) {
+    cerr << "synapse group " << name << " in " << connFile << " is not a valid group of " << preN << " x " << postN << " neurons ... exiting" << endl;
+    exit(1);
+  }
+  CStopWatch w;
+  w.startTimer();
+#ifdef CPU_ONLY
+  if (!copy && (e->valueBytes == sizeof(scalar))) {
+    mapSparse(C, g, e->nnz, conn.indInG(e), conn.ind(e), (scalar *) conn.values(e));
+  }
+  else
 #endif
+  {
+    allocate(e->nnz);
+    memcpy(C.indInG, conn.indInG(e), (preN+1)*sizeof(unsigned int));
+    memcpy(C.ind, conn.ind(e), e->nnz*sizeof(unsigned int));
+    for (uint64_t n= 0; n < e->nnz; n++) g[n]= conn.value(e, n);
+  }
+  w.stopTimer();
+  cerr << "% " << name << ": " << e->nnz << " synapses from " << connFile << " in " << w.getElapsedTime() << " s" << endl;
+  return true;
+}
+
+// write the synapse groups, as built, to the connectivity file name
+void AL::write_conn(string name)
+{
+  conWriter w;
+  w.addCSR("ORNPN1", _NORN, _NPN, CORNPN1.indInG, CORNPN1.ind, gORNPN1);
+  w.addCSR("ORNPN", _NORN, _NPN, CORNPN.indInG, CORNPN.ind, gORNPN);
+  w.addCSR("ORNhLN", _NORN, _NhLN, CORNhLN.indInG, CORNhLN.ind, gORNhLN);
+  w.addCSR("PNhLN", _NPN, _NhLN, CPNhLN.indInG, CPNhLN.ind, gPNhLN);
+  w.addCSR("PNLHI", _NPN, _NLHI, CPNLHI.indInG, CPNLHI.ind, gPNLHI);
+#ifdef CPU_ONLY
+  if (!hLNhLNUniform)
+#endif
+  w.addCSR("hLNhLN", _NhLN, _NhLN, ChLNhLN.indInG, ChLNhLN.ind, ghLNhLN);
+  if (!w.write(name)) {
+    cerr << "could not write connectivity file " << name << " ... exiting" << endl;
+    exit(1);
+  }
+  cerr << "% synapse groups written to " << name << endl;
 }
 
+//--------------------------------------------------------------------------
+/*! \brief Construction of the synapse groups.
+
+  A group is built row by row; row i holds the synapses of presynaptic
+  neuron i, and its start indInG[i] follows from the regular connectivity,
+  so the rows do not depend on each other. With connRNG 1 the jitter of
+  synapse n of a group is a Philox normal keyed by the seed and counted by
+  n and the group, and the CPU build fills blocks of rows on nThreads
+  threads; the result does not depend on the number of threads. connRNG 0
+  draws the jitter from RG, row after row, as the GeNN version did.
+ */
+//--------------------------------------------------------------------------
+
+#define CONN_STREAM 0x8000000000000000ULL //!< Philox counters of the jitter; ORN draws count steps from 0
+
+enum connGroup {CONN_ORNPN1= 1, CONN_ORNPN, CONN_ORNhLN, CONN_PNhLN, CONN_PNLHI, CONN_hLNhLN};
+
+//! standard normal jitter of synapse n of group
+inline double connJitter(unsigned int group, unsigned int n)
+{
+  if (connRNG) return philoxNormal((uint64_t) seed, n, CONN_STREAM+group);
+  return RG.n();
+}
+
+template <class F>
+struct connectBlock {
+  F *row;
+  unsigned int rowN, blockN;
+  void operator()(unsigned int b, unsigned int) {
+    for (unsigned int i= b*rowN/blockN; i < (b+1)*rowN/blockN; i++) (*row)(i);
+  }
+};
+
+//! row(i) for i= 0 .. rowN-1 and a timing report
+template <class F>
+void connectRows(const char *name, unsigned int rowN, unsigned int connN, F &row)
+{
+  CStopWatch w;
+  w.startTimer();
+  unsigned int threadN= 1;
+#ifdef CPU_ONLY
+  if (connRNG) {
+    threadN= (nThreads > 0) ? nThreads : std::thread::hardware_concurrency();
+    if (threadN < 1) threadN= 1;
+  }
+  if (threadN > 1) {
+    workStealingPool pool(threadN);
+    connectBlock<F> b= {&row, rowN, min(rowN, 16*threadN)};
+    pool.parallelFor(b.blockN, b);
+  }
+  else
+#endif
+  for (unsigned int i= 0; i < rowN; i++) row(i);
+  w.stopTimer();
+  cerr << "% " << name << ": " << connN << " synapses in " << w.getElapsedTime() << " s (" << threadN << " thread(s))" << endl;
+}
+
+// the plasticity variables of ORNPN1 synapse n from its conductance
+inline void initORNPN1(unsigned int n)
+{
+    if (gORNPN1[n] < gORNPN1_MIN) gORNPN1[n]= gORNPN1_MIN;
+    double tmp = gORNPN1[n] / myORNPN1_p[0]*2.0 ;
+    if ((2.0-tmp)<1e-20) tmp=2.0-1e-19; 
+    double theGRaw= (0.5 * log( tmp / (2.0-tmp))*myORNPN1_p[3]) + myORNPN1_p[2];	
+    pORNPN1[n]= -5e-12; //pbase
+    grawORNPN1[n]= theGRaw;
+    lastupdateORNPN1[n]= 0.0;
+}
+
+struct ORNPN1Row {
+  void operator()(unsigned int r) {
+    CORNPN1.indInG[r]= r;
+    CORNPN1.ind[r]= (r/_nORN)*_nPN;
+    gORNPN1[r]= myORNPN1_ini[2]*(1.0+connJitter(CONN_ORNPN1, r)*myORNPN1_gjitter);
+    initORNPN1(r);
+  }
+};
+
 // Each ORN projects to a PN1 of its GLO
 void AL::connect_ORN_PN1()
 {
 #ifdef DEBUG
     cerr << "# entering connect_ORN_PN1 ..." << endl;
 #endif
-  unsigned int n= 0;
-  unsigned int connN= _NORN;
-  allocateORNPN1(connN);
-  for (int i= 0; i < _nGLO; i++) {
-    for (int j= 0; j < _nORN; j++) {
-#ifdef DEBUG
-	cerr << i*_nORN+j << ": ";
-#endif
-	CORNPN1.indInG[i*_nORN+j]= n;
-#ifdef DEBUG
-	cerr << n << " ";
-#endif
-	CORNPN1.ind[n]= i*_nPN;
-	gORNPN1[n]= myORNPN1_ini[2]*(1.0+RG.n()*myORNPN1_gjitter);
-	if (gORNPN1[n] < gORNPN1_MIN) gORNPN1[n]= gORNPN1_MIN;
-	double tmp = gORNPN1[n] / myORNPN1_p[0]*2.0 ;
-	if ((2.0-tmp)<1e-20) tmp=2.0-1e-19; 
-	double theGRaw= (0.5 * log( tmp / (2.0-tmp))*myORNPN1_p[3]) + myORNPN1_p[2];	
-//#ifdef DEBUG
-	cerr << i*_nPN << " ";
-	cerr << gORNPN1[n] << " ";
-	cerr << theGRaw << " " << " ";
-	cerr << myORNPN1_p[0]*(tanh((theGRaw-myORNPN1_p[2])/myORNPN1_p[3] )+1)/2 << endl;
-//#endif
-	pORNPN1[n]= -5e-12; //pbase
-	grawORNPN1[n]= theGRaw;
-	lastupdateORNPN1[n++]= 0.0;
-#ifdef DEBUG
-	cerr << endl;
-#endif	
-    }
+  if (conn_group("ORNPN1", CORNPN1, gORNPN1, _NORN, _NPN, allocateORNPN1, true)) {
+    // plastic: a copy, with the plasticity variables worked out from g
+    for (unsigned int n= 0; n < CORNPN1.connN; n++) initORNPN1(n);
+  }
+  else {
+    unsigned int connN= _NORN;
+    allocateORNPN1(connN);
+    ORNPN1Row row;
+    connectRows("ORN-PN1", _NORN, connN, row);
+    CORNPN1.indInG[_NORN]= connN;
   }
-  assert(n == connN);
-  CORNPN1.indInG[_NORN]= connN;
   createPosttoPreArray(_NORN, _NPN, &CORNPN1);
 }
 
+struct ORNPNRow {
+  void operator()(unsigned int r) {
+    unsigned int n= r*(_nPN-1);
+    CORNPN.indInG[r]= n;
+    for (int k= 1; k < _nPN; k++) {
+      CORNPN.ind[n]= (r/_nORN)*_nPN+k;
+      gORNPN[n]= myORNPN_ini[0]*(1.0+connJitter(CONN_ORNPN, n)*myORNPN_gjitter);
+      n++;
+    }
+  }
+};
+
 // Each ORN projects to all other PN of its GLO
 void AL::connect_ORN_PN()
 {
 #ifdef DEBUG
     cerr << "# entering connect_ORN_PN ..." << endl;
 #endif
-  unsigned int n= 0;
+  if (conn_group("ORNPN", CORNPN, gORNPN, _NORN, _NPN, allocateORNPN)) return;
   unsigned int connN= _NORN*(_nPN-1);
   allocateORNPN(connN);
-  for (int i= 0; i < _nGLO; i++) {
-    for (int j= 0; j < _nORN; j++) {
-#ifdef DEBUG
-	cerr << i*_nORN+j << ": ";
-#endif
-	CORNPN.indInG[i*_nORN+j]= n;
-      for (int k= 1; k < _nPN; k++) {
-#ifdef DEBUG
-	  cerr << n << " ";
-#endif
-	CORNPN.ind[n]= i*_nPN+k;
-	gORNPN[n++]= myORNPN_ini[0]*(1.0+RG.n()*myORNPN_gjitter);
-      }
-#ifdef DEBUG
-      cerr << endl;
-#endif
-	  
-    }
-  }
-  assert(n == connN);
+  ORNPNRow row;
+  connectRows("ORN-PN", _NORN, connN, row);
   CORNPN.indInG[_NORN]= connN;
 }
 
+struct ORNhLNRow {
+  void operator()(unsigned int r) {
+    unsigned int n= r*_nhLN;
+    CORNhLN.indInG[r]= n;
+    for (int k= 0; k < _nhLN; k++) {
+      CORNhLN.ind[n]= (r/_nORN)*_nhLN+k;
+      gORNhLN[n]= myORNhLN_ini[0]*(1.0+connJitter(CONN_ORNhLN, n)*myORNhLN_gjitter);
+      n++;
+    }
+  }
+};
+
 // each ORN projects to the hLNs in the corresponding GLO
 void AL::connect_ORN_hLN() 
 {
 #ifdef DEBUG
     cerr << "# entering connect_ORN_hLN ..." << endl;
 #endif
-  unsigned int n= 0;
+  if (conn_group("ORNhLN", CORNhLN, gORNhLN, _NORN, _NhLN, allocateORNhLN)) return;
   unsigned int connN= _NORN*_nhLN;
   allocateORNhLN(connN);
-  for (int i= 0; i < _nGLO; i++) {
-    for (int j= 0; j < _nORN; j++) {
-      CORNhLN.indInG[i*_nORN+j]= n;
-      for (int k= 0; k < _nhLN; k++) {
-	CORNhLN.ind[n]= i*_nhLN+k;
-	gORNhLN[n++]= myORNhLN_ini[0]*(1.0+RG.n()*myORNhLN_gjitter);
-      }
-    }
-  }
-  assert(n == connN);
+  ORNhLNRow row;
+  connectRows("ORN-hLN", _NORN, connN, row);
   CORNhLN.indInG[_NORN]= connN;
 }
 
+struct PNhLNRow {
+  void operator()(unsigned int r) {
+    unsigned int n= r*_nhLN;
+    CPNhLN.indInG[r]= n;
+    for (int k= 0; k < _nhLN; k++) {
+      CPNhLN.ind[n]= (r/_nPN)*_nhLN+k;
+      gPNhLN[n]= myPNhLN_ini[0]*(1.0+connJitter(CONN_PNhLN, n)*myPNhLN_gjitter);
+      n++;
+    }
+  }
+};
+
 // excite hLNs from PNs
 void AL::connect_PN_hLN()
 {
 #ifdef DEBUG
     cerr << "# entering connect_PN_hLN ..." << endl;
 #endif
-  unsigned int n= 0;
+  if (conn_group("PNhLN", CPNhLN, gPNhLN, _NPN, _NhLN, allocatePNhLN)) return;
   unsigned int connN= _NPN*_nhLN;
   allocatePNhLN(connN);
-  for (int i= 0; i < _nGLO; i++) {		
-    for (int j= 0; j < _nPN; j++) {
-      CPNhLN.indInG[i*_nPN+j]= n;
-      for (int k= 0; k < _nhLN; k++) {
-	CPNhLN.ind[n]= i*_nhLN+k;
-	gPNhLN[n++]= myPNhLN_ini[0]*(1.0+RG.n()*myPNhLN_gjitter);
-      }
-    }
-  }
-  assert(n == connN);
+  PNhLNRow row;
+  connectRows("PN-hLN", _NPN, connN, row);
   CPNhLN.indInG[_NPN]= connN;
 }
+
+// PN j < _NLHI of each GLO excites LHI j
+struct PNLHIRow {
+  void operator()(unsigned int r) {
+    unsigned int j= r%_nPN;
+    unsigned int n= (r/_nPN)*_NLHI+min(j, (unsigned int) _NLHI);
+    CPNLHI.indInG[r]= n;
+    if (j < (unsigned int) _NLHI) {
+      CPNLHI.ind[n]= j;
+      gPNLHI[n]= myPNLHI_ini[0]*(1.0+connJitter(CONN_PNLHI, n)*myPNLHI_gjitter);
+    }
+  }
+};
  
  // excite hLHIs from PNs
 void AL::connect_PN_LHI()
@@ -212,28 +389,11 @@ void AL::connect_PN_LHI()
 #ifdef DEBUG
     cerr << "# entering connect_PN_LHI ..." << endl;
 #endif
-  unsigned int n= 0;
+  if (conn_group("PNLHI", CPNLHI, gPNLHI, _NPN, _NLHI, allocatePNLHI)) return;
   unsigned int connN= _NLHI*_nGLO;
   allocatePNLHI(connN);
-  for (int i= 0; i < _nGLO; i++) {		
-    for (int j= 0; j < _nPN; j++) {
-#ifdef DEBUG
-      cerr << "# " << i*_nPN+j << ", " << n << ": ";
-#endif
-      CPNLHI.indInG[i*_nPN+j]= n;
-      if (j < _NLHI) {
-#ifdef DEBUG
-	cerr << j << " ";
-#endif
-	  CPNLHI.ind[n]= j;
-	  gPNLHI[n++]= myPNLHI_ini[0]*(1.0+RG.n()*myPNLHI_gjitter);
-      }
-#ifdef DEBUG
-    cerr << endl;
-#endif
-    }
-  }
-  assert(n == connN);
+  PNLHIRow row;
+  connectRows("PN-LHI", _NPN, connN, row);
   CPNLHI.indInG[_NPN]= connN;
 }
 
@@ -245,14 +405,32 @@ void AL::connect_hLN_PN(string name)
     cerr << "# entering connect_hLN_PN ..." << endl;
 #endif
     scalar gscale;
-  ifstream is(name.c_str());
-  if (!is.good()) {
-    cerr << "# error reading hLN-PN connections from file " << name << endl;
-    exit(1);
+  // a text matrix or the dense matrix hLNPN of a connectivity file
+  ifstream is;
+  conFile f;
+  const conEntry *e= NULL;
+  if (isConFile(name)) {
+    if (f.open(name)) e= f.find("hLNPN");
+    if ((e == NULL) || (e->kind != CONBIN_DENSE) || (e->rows != (unsigned int) _nGLO) || (e->cols != (unsigned int) _nGLO)) {
+      cerr << "# error: " << name << " has no " << _nGLO << " x " << _nGLO << " matrix hLNPN" << endl;
+      exit(1);
+    }
+  }
+  else {
+    is.open(name.c_str());
+    if (!is.good()) {
+      cerr << "# error reading hLN-PN connections from file " << name << endl;
+      exit(1);
+    }
   }
   for (int i= 0; i < _nGLO; i++) {
     for (int j= 0; j < _nGLO; j++) {
-      is >> gscale;
+      if (e != NULL) gscale= f.value(e, i*_nGLO+j);
+      else is >> gscale;
+#ifdef CPU_ONLY
+      // the CPU engine only keeps the glomerular matrix
+      ghLNPNGlo[i*_nGLO+j]= gscale*myhLNPN_ini[0];
+#else
       for (int k= 0; k < _nhLN; k++) {
 	for (int l= 0; l < _nPN; l++) {
 	  ghLNPN[(i*_nhLN+k)*_NPN+j*_nPN+l]= gscale*myhLNPN_ini[0];
@@ -261,48 +439,64 @@ void AL::connect_hLN_PN(string name)
 #endif
 	}
       }
+#endif
     }
   }
 #ifdef DEBUG
   cerr << endl;
-  assert(is.good());
+  assert((e != NULL) || is.good());
 #endif
   is.close();
+#ifdef CPU_ONLY
+  setLowRankhLNPN(LNPNrank);
+#else
+  if (LNPNrank > 0) cerr << "% LNPNrank needs the CPU engine, using the exact hLN-PN matrix" << endl;
+#endif
 }
 
+struct hLNhLNRow {
+  void operator()(unsigned int r) {
+    unsigned int n= r*(_NhLN-_nhLN);
+    int i= r/_nhLN;
+    ChLNhLN.indInG[r]= n;
+    for (int j= 0; j < _nGLO; j++) {
+      if (i != j) { // only inhibit other GLO
+	for (int l= 0; l < _nhLN; l++) { 
+	  ChLNhLN.ind[n]= j*_nhLN+l;
+	  if (myhLNhLN_gjitter != 0.0) ghLNhLN[n]= myhLNhLN_ini[0]*(1.0+connJitter(CONN_hLNhLN, n)*myhLNhLN_gjitter);
+	  else ghLNhLN[n]= myhLNhLN_ini[0];
+	  n++;
+	}
+      }
+    }
+  }
+};
+
 // homo LNs can inhibit each other ...
 void AL::connect_hLN_hLN()
 {
 #ifdef DEBUG
     cerr << "# entering connect_hLN_hLN ..." << endl;
 #endif
-    unsigned int n= 0;
-    unsigned int connN= _NhLN*(_NhLN-_nhLN);
-    allocatehLNhLN(connN);
-    for (int i= 0; i < _nGLO; i++) {
-	for (int k= 0; k < _nhLN; k++) {
-	    ChLNhLN.indInG[i*_nhLN+k]= n;
-#ifdef DEBUG
-	    cerr << i*_nhLN+k << ": ";
-#endif
-	    for (int j= 0; j < _nGLO; j++) {
-		if (i != j) { // only inhibit other GLO
-		    for (int l= 0; l < _nhLN; l++) { 
-#ifdef DEBUG
-			cerr << n << " " << j*_nhLN+l << " ";
+  if (conn_group("hLNhLN", ChLNhLN, ghLNhLN, _NhLN, _NhLN, allocatehLNhLN)) {
+#ifdef CPU_ONLY
+    hLNhLNUniform= false;
 #endif
-			ChLNhLN.ind[n]= j*_nhLN+l;
-			ghLNhLN[n++]= myhLNhLN_ini[0];
-		    }
-		}
-	    }
-#ifdef DEBUG
-	    cerr << endl;
+    return;
+  }
+  unsigned int connN= _NhLN*(_NhLN-_nhLN);
+#ifdef CPU_ONLY
+  if (myhLNhLN_gjitter == 0.0) {
+    // all weights are equal: the CPU engine does without the graph
+    setUniformhLNhLN(myhLNhLN_ini[0]);
+    cerr << "% hLN-hLN: uniform, " << connN << " synapses without a graph" << endl;
+    return;
+  }
 #endif
-	}
-    }
-    assert(n == connN);
-    ChLNhLN.indInG[_NhLN]= connN;
+  allocatehLNhLN(connN);
+  hLNhLNRow row;
+  connectRows("hLN-hLN", _NhLN, connN, row);
+  ChLNhLN.indInG[_NhLN]= connN;
 }
 
 void AL::initialize_ORN_seeds() {
@@ -312,10 +506,12 @@ void AL::initialize_ORN_seeds() {
   for (int i= 0; i < _NORN; i++) {
     seedORN[i]= (uint64_t) (R.n()*1e8);
   }
+#ifndef CPU_ONLY
   if (device == GPU) {
     unsigned int size= _NORN*sizeof(uint64_t);
     CHECK_CUDA_ERRORS(cudaMemcpy(d_seedORN, seedORN, size, cudaMemcpyHostToDevice));
   }
+#endif
 }
 
 void AL::initialize_input()
@@ -324,14 +520,21 @@ void AL::initialize_input()
     cerr << "# entering initialize_input ..." << endl;
 #endif
   // need to make sure that allocateMem() has already been called before this 
+  theKK= new scalar[_nGLO*12];
+  for (int i= 0; i < _nGLO*12; i++) {
+    theKK[i]= 0.0;
+  }
+#ifndef CPU_ONLY
   size_t size= _nGLO*12*sizeof(scalar);
   scalar **tmpKK= new scalar*[_NORN];
-  theKK= new scalar[_nGLO*12];
   CHECK_CUDA_ERRORS(cudaMalloc(&d_theKK, size));
+#endif
   for (int i= 0; i< _nGLO; i++) {
     for (int j= 0; j < _nORN; j++) {
 			kkORN[i*_nORN+j]= theKK+(12*i);
+#ifndef CPU_ONLY
       tmpKK[i*_nORN+j]= d_theKK+(12*i);
+#endif
 #ifdef DEBUG 
       cerr << i*_nORN+j << " " ;
 #endif
@@ -340,53 +543,115 @@ void AL::initialize_input()
 #ifdef DEBUG 
   cerr << endl;
 #endif
+#ifndef CPU_ONLY
   size= _NORN*sizeof(scalar *);
   CHECK_CUDA_ERRORS(cudaMemcpy(d_kkORN, tmpKK, size, cudaMemcpyHostToDevice));
-#ifdef DEBUG
-   // make sure the odors are initially all removed (initialized to 0)
+  delete[] tmpKK;
+#endif
+  // make sure the odors are initially all removed (initialized to 0)
   remove_input(0);
   remove_input(1);
+#ifdef DEBUG
   cerr << "# exiting initialize_input ..." << endl;
 #endif
 }
 
-void AL::read_protocol(ifstream &is)
+const char *protoOpName[]= {"odor", "odor", "reward", "input"};
+
+// protocol error in line of src
+void protoError(const string &src, int line, const string &msg)
+{
+    cerr << src << ":" << line << ": " << msg << " ... exiting" << endl;
+    exit(1);
+}
+
+struct protoEarlier {
+    bool operator()(const proto_item &a, const proto_item &b) const { return a.t < b.t; }
+};
+
+//--------------------------------------------------------------------------
+/*! \brief Compile the protocol in is and append it to proto.
+
+  Each line is "<t> odor <slot> <odor> <log10 c> <1/-1>", "<t> reward <R>"
+  or "<t> input <LHI> <value>"; blank lines and '#' comments are skipped.
+  The arguments are checked here, so that a bad protocol stops the program
+  at the start with the line at fault. The events are sorted by time,
+  those at the same time staying in the order of the file.
+ */
+//--------------------------------------------------------------------------
+
+void AL::parse_protocol(istream &is, vector<proto_item> &proto, string src)
 {
-    proto_item p;
-    int found;
-    is >> p.t;
-    while (is.good()) {
-	is >> p.action;
-	found= 0;
-	if (p.action == "odor") {
-	    is >> p.value[0].i;
-	    is >> p.value[1].i;
-	    is >> p.value[2].d;
-	    is >> p.value[3].i;
-	    found= 1;
+    vector<proto_item> items;
+    string line, word;
+    int lineN= 0;
+    while (getline(is, line)) {
+	lineN++;
+	stringstream s(line);
+	if (!(s >> word) || (word[0] == '#')) continue;
+	proto_item p;
+	memset(&p, 0, sizeof(p));
+	p.line= lineN;
+	char *end;
+	p.t= strtod(word.c_str(), &end);
+	if ((*end != '\0') || !(p.t >= 0.0) || (p.t == HUGE_VAL)) protoError(src, lineN, "bad time " + word);
+	string action;
+	s >> action;
+	if (action == "odor") {
+	    int on;
+	    if (!(s >> p.value[0].i >> p.value[1].i >> p.value[2].d >> on)) protoError(src, lineN, "odor needs <slot> <odor> <log10 concentration> <1 | -1>");
+	    if ((p.value[0].i < 0) || (p.value[0].i > 1)) protoError(src, lineN, "odor slot must be 0 or 1");
+	    if ((on != 1) && (on != -1)) protoError(src, lineN, "odor must be switched on (1) or off (-1), not " + toString(on));
+	    if ((on == 1) && ((p.value[1].i < 0) || (p.value[1].i >= _nOdor))) protoError(src, lineN, "odor " + toString(p.value[1].i) + " does not exist, there are " + toString(_nOdor));
+	    if (!isfinite(p.value[2].d)) protoError(src, lineN, "bad concentration");
+	    p.value[3].i= on;
+	    p.op= (on == 1) ? PROTO_ODOR_ON : PROTO_ODOR_OFF;
 	}
-	if (p.action == "reward") {
-	    is >> p.value[0].d;
-	    found= 1;
+	else if (action == "reward") {
+	    if (!(s >> p.value[0].d) || !isfinite(p.value[0].d)) protoError(src, lineN, "reward needs a value");
+	    p.op= PROTO_REWARD;
 	}
-	if (p.action == "input") {
-	    is >> p.value[0].i;
-	    is >> p.value[1].d;
-	    found= 1;
-	}
-	if (!found) {
-	    cerr << "unrecognized action" << p.action << " in protocol ..." << endl;
-	    exit(1);
+	else if (action == "input") {
+	    if (!(s >> p.value[0].i >> p.value[1].d) || !isfinite(p.value[1].d)) protoError(src, lineN, "input needs <neuron> <value>");
+	    if ((p.value[0].i < 0) || (p.value[0].i >= _NLHI)) protoError(src, lineN, "input neuron must be below " + toString(_NLHI));
+	    p.op= PROTO_INPUT;
 	}
-	proto.push_back(p);
-	is >> p.t;
+	else protoError(src, lineN, "unrecognized action " + action);
+	if ((s >> word) && (word[0] != '#')) protoError(src, lineN, "unexpected " + word);
+	items.push_back(p);
     }
+    stable_sort(items.begin(), items.end(), protoEarlier());
+    proto.insert(proto.end(), items.begin(), items.end());
+}
+
+void AL::read_protocol(ifstream &is, string src)
+{
+    parse_protocol(is, proto, src);
+    load_odors(proto);
     iProto= 0;
 #ifdef DEBUG
     cerr << "# protocol read with " << proto.size() << " items." << endl;
 #endif
 }
 
+// continue with the protocol in is; its items that are already past must be the ones that were done
+void AL::switch_protocol(ifstream &is, string src)
+{
+    vector<proto_item> done(proto.begin(), proto.begin()+iProto);
+    proto.clear();
+    read_protocol(is, src);
+    double tdone= (iT-1)*DT; // the time protocol_handler() saw last
+    while ((iT > 0) && (iProto < (int) proto.size()) && (proto[iProto].t <= tdone)) iProto++;
+    bool same= (iProto == (int) done.size());
+    for (int i= 0; same && (i < iProto); i++) {
+	same= (proto[i].t == done[i].t) && (proto[i].op == done[i].op) && (memcmp(proto[i].value, done[i].value, sizeof(proto[i].value)) == 0);
+    }
+    if (!same) {
+	cerr << "% warning: the new protocol does not start with the " << done.size() << " items done so far" << endl;
+    }
+    cerr << "% protocol switched at t= " << t << ", continuing with item " << iProto << " of " << proto.size() << endl;
+}
+
 void AL::add_input(unsigned int od, double c, unsigned int pos) //c in log10 
 {
 #ifdef DEBUG
@@ -394,16 +659,21 @@ void AL::add_input(unsigned int od, double c, unsigned int pos) //c in log10
     cerr << "% setting input " << od << " at concentration " << c << " in slot " << pos << endl;
 #endif
   // note: theKK[*][5] is the concentration ...
+  const double *pp= odor(od);
+  scalar cc= pow(10.0,c);
   for (int i= 0; i < _nGLO; i++) {
-    for (int l= 0; l < 5; l++) {
-      theKK[i*12+pos*6+l]= odorPP[od][i][l];
-      theKK[i*12+pos*6+5]= pow(10.0,c);
-    }
+    scalar *kk= theKK+i*12+pos*6;
+    for (int l= 0; l < 5; l++) kk[l]= pp[i*5+l];
+    kk[5]= cc;
   }
+#ifndef CPU_ONLY
   if (device == GPU) {
     unsigned int size= _nGLO*12*sizeof(scalar);
     CHECK_CUDA_ERRORS(cudaMemcpy(d_theKK, theKK, size, cudaMemcpyHostToDevice));
   }
+#else
+  inputChangedCPU();
+#endif
 }
 
 void AL::remove_input(unsigned int pos) 
@@ -414,10 +684,14 @@ void AL::remove_input(unsigned int pos)
   for (int i= 0; i < _nGLO; i++) {
       theKK[i*12+pos*6+5]= 0.0;
   }
+#ifndef CPU_ONLY
   if (device == GPU) {
     unsigned int size= _nGLO*12*sizeof(scalar);
     CHECK_CUDA_ERRORS(cudaMemcpy(d_theKK, theKK, size, cudaMemcpyHostToDevice));
   }
+#else
+  inputChangedCPU();
+#endif
 }
 
 void AL::allocate_direct_input(){
@@ -429,40 +703,46 @@ void AL::allocate_direct_input(){
     for (int i= 0; i < _NKC; i++) {
 	directinput2[i]= -2.5*0.001;//(-17.5+4*i)*0.001;
     }*/
+#ifndef CPU_ONLY
     if (device == GPU) {
         CHECK_CUDA_ERRORS(cudaMalloc((void**) &d_directinput, _NLHI*sizeof(double)));
 	CHECK_CUDA_ERRORS(cudaMemcpy(d_directinput, directinput, _NLHI*sizeof(double), cudaMemcpyHostToDevice));
     }
+#endif
 }
 
 void AL::set_directInput(int id, double val)
 {
     directinput[id] = (scalar) val;
+#ifndef CPU_ONLY
     if (device == GPU) CHECK_CUDA_ERRORS(cudaMemcpy(d_directinput, directinput, _NLHI*sizeof(double), cudaMemcpyHostToDevice));
+#endif
 }
 
 void AL::protocol_handler(double t)
 {
-    proto_item p;
-    while ((iProto < proto.size()) && (t >= proto[iProto].t)) {
-	p= proto[iProto];
-	if (p.action == "odor") {
-	    if (p.value[3].i == 1) {
-		add_input(p.value[1].i, p.value[2].d, p.value[0].i); 
-		cerr << "# t: " << t << " - added input " << p.value[1].i  << " conc=" << p.value[2].d << endl;
-	    }
-	    else {
-		remove_input(p.value[0].i);
-		cerr << "# t: " << t << " - removed input from slot " << p.value[0].i << endl;
-	    }
-	}
-	if (p.action == "reward") {
+    while ((iProto < (int) proto.size()) && (t >= proto[iProto].t)) {
+	const proto_item &p= proto[iProto];
+	switch (p.op) {
+	case PROTO_ODOR_ON:
+	    add_input(p.value[1].i, p.value[2].d, p.value[0].i); 
+	    cerr << "# t: " << t << " - added input " << p.value[1].i  << " conc=" << p.value[2].d << endl;
+	    break;
+	case PROTO_ODOR_OFF:
+	    remove_input(p.value[0].i);
+	    cerr << "# t: " << t << " - removed input from slot " << p.value[0].i << endl;
+	    break;
+	case PROTO_REWARD:
 	    reward= p.value[0].d;
+#ifdef CPU_ONLY
+	    rewardChangedCPU(base_RORNPN1+reward);
+#endif
 	    cerr << "# t: " << t << " - set reward to " << p.value[0].d << endl;
-	}
-	if (p.action == "input") {
+	    break;
+	case PROTO_INPUT:
 	    set_directInput(p.value[0].i, p.value[1].d);
 	    cerr << "# t: " << t << " - set input to neuron " << p.value[0].i << " to " << p.value[1].d << endl;
+	    break;
 	}
 	iProto++;
     }
@@ -473,28 +753,76 @@ void AL::protocol_handler(double t)
 
 void AL::run()
 {
-#ifdef DEBUG
-//    cerr << "# entering run() ..." << endl;
-#endif
-    assert(enabled);
-    protocol_handler(t);
-    RORNPN1+= (base_RORNPN1+reward-RORNPN1)/RORNPN1_tau*DT;
-    RORN= RORNPN1; // make a true copy
-    
-		/*if (t==100){
-	    for (int i= 0; i < _NKC; i++) {
-				directinput2[i]= (10.5+i)*0.001;
-	    }
-		} */
+    run_until(t);
+}
 
-  if (device == GPU) {
-      stepTimeGPU(d_directinput,t);
-  }
-  else {
-      stepTimeCPU(directinput,t);
-  }
-  iT++;
-  t= iT*DT;
+//--------------------------------------------------------------------------
+/*! \brief Run a block of steps, from t up to the next protocol event or
+  while t < tEnd, whichever comes first, but at least one step. Returns
+  the number of steps.
+
+  Between protocol events only the neurons and synapses change, so the
+  steps of a block are taken in one loop. R relaxes to Rt=
+  base_RORNPN1+reward as R_k= Rt+(R_0-Rt) q^k, q= 1-DT/RORNPN1_tau; the
+  trace of the block is worked out before the loop, by the same Euler
+  recurrence the single steps used, so that R does not change in the last
+  digit. The spikes of the steps go to blockT, blockSpkN and blockSpk for
+  the caller to write out after the block.
+ */
+//--------------------------------------------------------------------------
+
+unsigned int AL::run_until(double tEnd)
+{
+    assert(enabled);
+    if (t >= next_event()) protocol_handler(t);
+    // once the protocol has ended there is one more step, as before
+    unsigned int n= 1;
+    if (continues()) {
+	double tNext= min(tEnd, next_event());
+	while ((iT+n)*DT < tNext) n++;
+    }
+    blockR.resize(n);
+    scalar R= RORNPN1;
+    for (unsigned int k= 0; k < n; k++) {
+	R+= (base_RORNPN1+reward-R)/RORNPN1_tau*DT;
+	blockR[k]= R;
+    }
+    blockT.resize(n);
+    blockSpkN.resize(n);
+    blockSpk.clear();
+    for (int i= 0; i < 4; i++) blockCount[i]= 0;
+    for (unsigned int k= 0; k < n; k++) {
+	RORNPN1= blockR[k];
+	RORN= RORNPN1; // make a true copy
+#ifndef CPU_ONLY
+	if (device == GPU) {
+	    stepTimeGPU(d_directinput,t);
+	}
+	else {
+	    stepTimeCPU(directinput,t);
+	}
+#else
+	stepTimeCPU(directinput,t);
+#endif
+	iT++;
+	t= iT*DT;
+#ifndef CPU_ONLY
+	if (device == GPU) {
+	    copySpikeNFromDevice();
+	    copySpikesFromDevice();
+	}
+#endif
+	blockCount[0]+= spikeCount_ORN;
+	blockCount[1]+= spikeCount_PN;
+	blockCount[2]+= spikeCount_hLN;
+	blockCount[3]+= spikeCount_LHI;
+	blockT[k]= t;
+	blockSpkN[k]= spikeCount_PN+spikeCount_hLN+spikeCount_LHI;
+	for (int i= 0; i < spikeCount_PN; i++) blockSpk.push_back(spike_PN[i]);
+	for (int i= 0; i < spikeCount_hLN; i++) blockSpk.push_back(spike_hLN[i]+_NPN);
+	for (int i= 0; i < spikeCount_LHI; i++) blockSpk.push_back(spike_LHI[i]+_NPN+_NhLN);
+    }
+    return n;
 }
 
 
@@ -502,102 +830,130 @@ void AL::output_state(ostream &os)
 {
 }
 
-void AL::output_full_state(ostream &os)
+// the values of a line of the .out.cmp file after t
+void AL::full_state_values(vector<double> &v)
 {
+#ifndef CPU_ONLY
     if (device == GPU) {
 	copyStateFromDevice();
     }
-    os << t << " ";
+#else
+    syncStateCPU();
+#endif
+    v.clear();
 /*    for (int i= 0; i < _NORN; i++) {
-	os << VORN[i] << " ";
-	os << r0ORN[i] << " ";
-	os << rs0ORN[i] << " ";
-	os << r1ORN[i] << " ";
-	os << rs1ORN[i] << " ";
-	os << adORN[i] << " ";
-	os << rbORN[i] << " ";
-	os << trateORN[i] << " ";
-	os << refractORN[i] << " ";
-	os << seedORN[i] << "   ";
-    }
-    os << "   ";
+	v.push_back(VORN[i]);
+	v.push_back(r0ORN[i]);
+	v.push_back(rs0ORN[i]);
+	v.push_back(r1ORN[i]);
+	v.push_back(rs1ORN[i]);
+	v.push_back(adORN[i]);
+	v.push_back(rbORN[i]);
+	v.push_back(trateORN[i]);
+	v.push_back(refractORN[i]);
+	v.push_back(seedORN[i]);
+    }
     for (int i= 0; i < _NPN; i++) {
-	os << VPN[i] << " ";
-	os << mPN[i] << " ";
-	os << hPN[i] << " ";
-	os << nPN[i] << " ";
-	os << rPN[i] << "   ";
+	v.push_back(VPN[i]);
+	v.push_back(mPN[i]);
+	v.push_back(hPN[i]);
+	v.push_back(nPN[i]);
+	v.push_back(rPN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NhLN; i++) {
-	os << VhLN[i] << " ";
-	os << mhLN[i] << " ";
-	os << hhLN[i] << " ";
-	os << nhLN[i] << " ";
-	os << rhLN[i] << "   ";
+	v.push_back(VhLN[i]);
+	v.push_back(mhLN[i]);
+	v.push_back(hhLN[i]);
+	v.push_back(nhLN[i]);
+	v.push_back(rhLN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NPN; i++) {
-	os << inSynORNPN[i] << "   ";
+	v.push_back(inSynORNPN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NPN; i++) {
-	os << inSynhLNPN[i] << "   ";
+	v.push_back(inSynhLNPN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NhLN; i++) {
-	os << inSynORNhLN[i] << "   ";
+	v.push_back(inSynORNhLN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NhLN; i++) {
-	os << inSynPNhLN[i] << "   ";
+	v.push_back(inSynPNhLN[i]);
     }
-    os << "   ";
     for (int i= 0; i < _NhLN; i++) {
-	os << inSynhLNhLN[i] << "   ";
+	v.push_back(inSynhLNhLN[i]);
 	}*/
     /*for (int i= 0; i < _NLHI; i++) {
-	os << VLHI[i] << " ";
-	os << mLHI[i] << " ";
-	os << hLHI[i] << " ";
-	os << nLHI[i] << " ";
-	os << rLHI[i] << "   ";
+	v.push_back(VLHI[i]);
+	v.push_back(mLHI[i]);
+	v.push_back(hLHI[i]);
+	v.push_back(nLHI[i]);
+	v.push_back(rLHI[i]);
     }*/
     /*  for (int i= 0; i < CORNPN1.connN; i++) {
-      os << pORNPN1[i] << " ";
-      os << gORNPN1[i] << " ";
-      os << lastupdateORNPN1[i] << " ";
+      v.push_back(pORNPN1[i]);
+      v.push_back(gORNPN1[i]);
+      v.push_back(lastupdateORNPN1[i]);
       }*/
     /*for (int i= 0; i < _NLHI; i++) {
-      os << inSynPNLHI[i] << " ";
+      v.push_back(inSynPNLHI[i]);
     }*/
-    os << pORNPN1[0] << " ";
-    os << gORNPN1[0] << " ";
-    os << RORNPN1 << " ";
-    os << pORNPN1[_nORN] << " ";
-    os << pORNPN1[_nORN*5] << " ";
-    os << pORNPN1[_nORN*12] << " ";
-    os << gORNPN1[_nORN] << " ";
-    os << gORNPN1[_nORN*5] << " ";
-    os << gORNPN1[_nORN*12] << " ";
-    os << grawORNPN1[_nORN] << " ";
-    os << grawORNPN1[_nORN*5] << " ";
-    os << grawORNPN1[_nORN*12] << " ";
-    os << VPN[0] << " ";
-    os << VPN[1] << " ";
-    os << VPN[5] << " ";
-    os << VPN[12] << " ";
-   	os << pORNPN1[_nORN*2] << " ";
-    os << pORNPN1[_nORN*9] << " ";
-    os << pORNPN1[_nORN*25] << " ";
-    os << gORNPN1[_nORN*2] << " ";
-    os << gORNPN1[_nORN*9] << " ";
-    os << gORNPN1[_nORN*25] << " ";
-    os << grawORNPN1[_nORN*2] << " ";
-    os << grawORNPN1[_nORN*9] << " ";
-    os << grawORNPN1[_nORN*25] << " ";
-    os << VLHI[0] << " ";
-    os << VLHI[1] << " ";
+    v.push_back(pORNPN1[0]);
+    v.push_back(gORNPN1[0]);
+    v.push_back(RORNPN1);
+    v.push_back(pORNPN1[_nORN]);
+    v.push_back(pORNPN1[_nORN*5]);
+    v.push_back(pORNPN1[_nORN*12]);
+    v.push_back(gORNPN1[_nORN]);
+    v.push_back(gORNPN1[_nORN*5]);
+    v.push_back(gORNPN1[_nORN*12]);
+    v.push_back(grawORNPN1[_nORN]);
+    v.push_back(grawORNPN1[_nORN*5]);
+    v.push_back(grawORNPN1[_nORN*12]);
+    v.push_back(VPN[0]);
+    v.push_back(VPN[1]);
+    v.push_back(VPN[5]);
+    v.push_back(VPN[12]);
+   	v.push_back(pORNPN1[_nORN*2]);
+    v.push_back(pORNPN1[_nORN*9]);
+    v.push_back(pORNPN1[_nORN*25]);
+    v.push_back(gORNPN1[_nORN*2]);
+    v.push_back(gORNPN1[_nORN*9]);
+    v.push_back(gORNPN1[_nORN*25]);
+    v.push_back(grawORNPN1[_nORN*2]);
+    v.push_back(grawORNPN1[_nORN*9]);
+    v.push_back(grawORNPN1[_nORN*25]);
+    v.push_back(VLHI[0]);
+    v.push_back(VLHI[1]);
+}
+
+// the names of the values of full_state_values
+void AL::full_state_names(vector<string> &n)
+{
+    n.clear();
+    n.push_back("pORNPN1[0]");
+    n.push_back("gORNPN1[0]");
+    n.push_back("RORNPN1");
+    int syn[3]= { 1, 5, 12 };
+    for (int i= 0; i < 3; i++) n.push_back("pORNPN1["+toString(_nORN*syn[i])+"]");
+    for (int i= 0; i < 3; i++) n.push_back("gORNPN1["+toString(_nORN*syn[i])+"]");
+    for (int i= 0; i < 3; i++) n.push_back("grawORNPN1["+toString(_nORN*syn[i])+"]");
+    n.push_back("VPN[0]");
+    n.push_back("VPN[1]");
+    n.push_back("VPN[5]");
+    n.push_back("VPN[12]");
+    int syn2[3]= { 2, 9, 25 };
+    for (int i= 0; i < 3; i++) n.push_back("pORNPN1["+toString(_nORN*syn2[i])+"]");
+    for (int i= 0; i < 3; i++) n.push_back("gORNPN1["+toString(_nORN*syn2[i])+"]");
+    for (int i= 0; i < 3; i++) n.push_back("grawORNPN1["+toString(_nORN*syn2[i])+"]");
+    n.push_back("VLHI[0]");
+    n.push_back("VLHI[1]");
+}
+
+void AL::output_full_state(ostream &os)
+{
+    full_state_values(fsBuf);
+    os << t << " ";
+    for (unsigned int i= 0; i < fsBuf.size(); i++) os << fsBuf[i] << " ";
     os << endl;
 }
 
@@ -652,26 +1008,267 @@ void AL::output_state_st(ostream &osr)
     int offset= 0;
 
     for (int i= 0; i < spikeCount_PN; i++) {
-	osr << t << " " << spike_PN[i]+offset << endl;
+	osr << t << " " << spike_PN[i]+offset << '\n';
     }
     offset+= _NPN;
     for (int i= 0; i < spikeCount_hLN; i++) {
-	osr << t << " " << spike_hLN[i]+offset << endl;
+	osr << t << " " << spike_hLN[i]+offset << '\n';
     }
     offset+= _NhLN;
     for (int i= 0; i < spikeCount_LHI; i++) {
-	osr << t << " " << spike_LHI[i]+offset << endl;
+	osr << t << " " << spike_LHI[i]+offset << '\n';
     }   
     offset+=_NLHI; 
 
 		//Following is commented out as it is costly. Uncomment if you want ORN spike times.
    /* for (int i= 0; i < spikeCount_ORN; i++) {
-	osr << t << " " << spike_ORN[i]+offset << endl;
+	osr << t << " " << spike_ORN[i]+offset << '\n';
     }
     offset+= _NORN;*/
 }
 
 
+// the ids of the spikes of the last step, with the offsets of output_state_st
+void AL::spike_ids(vector<unsigned int> &ids)
+{
+    ids.clear();
+    for (int i= 0; i < spikeCount_PN; i++) ids.push_back(spike_PN[i]);
+    for (int i= 0; i < spikeCount_hLN; i++) ids.push_back(spike_hLN[i]+_NPN);
+    for (int i= 0; i < spikeCount_LHI; i++) ids.push_back(spike_LHI[i]+_NPN+_NhLN);
+}
+
+// the same spikes in the binary spike format
+void AL::output_state_st(spikeWriter &w)
+{
+    spike_ids(stBuf);
+    w.write(t, stBuf.data(), stBuf.size());
+}
+
+// hash of the fixed connectivity; a state file only fits the network it was written from
+uint64_t AL::network_hash()
+{
+    uint64_t h= fnv1a(CORNPN1.ind, CORNPN1.connN*sizeof(unsigned int));
+    h= fnv1a(CORNPN.ind, CORNPN.connN*sizeof(unsigned int), h);
+    h= fnv1a(gORNPN, CORNPN.connN*sizeof(scalar), h);
+    h= fnv1a(CORNhLN.ind, CORNhLN.connN*sizeof(unsigned int), h);
+    h= fnv1a(gORNhLN, CORNhLN.connN*sizeof(scalar), h);
+    h= fnv1a(CPNhLN.ind, CPNhLN.connN*sizeof(unsigned int), h);
+    h= fnv1a(gPNhLN, CPNhLN.connN*sizeof(scalar), h);
+#ifdef CPU_ONLY
+    // hashed as the dense matrix, so that both builds agree
+    for (int i= 0; i < _NhLN; i++) {
+	for (int j= 0; j < _NPN; j++) h= fnv1a(&ghLNPNGlo[(i/_nhLN)*_nGLO+j/_nPN], sizeof(scalar), h);
+    }
+#else
+    h= fnv1a(ghLNPN, _NhLN*_NPN*sizeof(scalar), h);
+#endif
+#ifdef CPU_ONLY
+    if (hLNhLNUniform) {
+	// hashed as the graph it stands for
+	for (int i= 0; i < _NhLN; i++) {
+	    for (unsigned int j= 0; j < (unsigned int) _NhLN; j++) {
+		if (j/_nhLN != i/_nhLN) h= fnv1a(&j, sizeof(unsigned int), h);
+	    }
+	}
+	for (int i= 0; i < _NhLN*(_NhLN-_nhLN); i++) h= fnv1a(&ghLNhLNUniform, sizeof(scalar), h);
+    }
+    else
+#endif
+    {
+	h= fnv1a(ChLNhLN.ind, ChLNhLN.connN*sizeof(unsigned int), h);
+	h= fnv1a(ghLNhLN, ChLNhLN.connN*sizeof(scalar), h);
+    }
+    h= fnv1a(CPNLHI.ind, CPNLHI.connN*sizeof(unsigned int), h);
+    h= fnv1a(gPNLHI, CPNLHI.connN*sizeof(scalar), h);
+    return h;
+}
+
+#define STATE_VALUE(c, X) c.data(#X, &(X), sizeof(X))
+#define STATE_ARRAY(c, X, N) c.data(#X, X, (N)*sizeof(*(X)))
+
+// the working state that changes during a run, in both directions of c
+void AL::state_io(checkpoint &c)
+{
+    STATE_VALUE(c, t);
+    STATE_VALUE(c, iT);
+    STATE_VALUE(c, iProto);
+    STATE_VALUE(c, reward);
+    STATE_VALUE(c, RORNPN1);
+    STATE_VALUE(c, RORN);
+    STATE_ARRAY(c, theKK, _nGLO*12);
+    STATE_ARRAY(c, directinput, _NLHI);
+
+    STATE_ARRAY(c, glbSpkCntORN, 1);
+    STATE_ARRAY(c, glbSpkORN, _NORN);
+    STATE_ARRAY(c, sTORN, _NORN);
+    STATE_ARRAY(c, VORN, _NORN);
+    STATE_ARRAY(c, r0ORN, _NORN);
+    STATE_ARRAY(c, rs0ORN, _NORN);
+    STATE_ARRAY(c, r1ORN, _NORN);
+    STATE_ARRAY(c, rs1ORN, _NORN);
+    STATE_ARRAY(c, adORN, _NORN);
+    STATE_ARRAY(c, rbORN, _NORN);
+    STATE_ARRAY(c, trateORN, _NORN);
+    STATE_ARRAY(c, refractORN, _NORN);
+    STATE_ARRAY(c, seedORN, _NORN);
+
+    STATE_ARRAY(c, glbSpkCntPN, 1);
+    STATE_ARRAY(c, glbSpkPN, _NPN);
+    STATE_ARRAY(c, sTPN, _NPN);
+    STATE_ARRAY(c, VPN, _NPN);
+    STATE_ARRAY(c, mPN, _NPN);
+    STATE_ARRAY(c, hPN, _NPN);
+    STATE_ARRAY(c, nPN, _NPN);
+    STATE_ARRAY(c, rPN, _NPN);
+
+    STATE_ARRAY(c, glbSpkCnthLN, 1);
+    STATE_ARRAY(c, glbSpkhLN, _NhLN);
+    STATE_ARRAY(c, sThLN, _NhLN);
+    STATE_ARRAY(c, VhLN, _NhLN);
+    STATE_ARRAY(c, mhLN, _NhLN);
+    STATE_ARRAY(c, hhLN, _NhLN);
+    STATE_ARRAY(c, nhLN, _NhLN);
+    STATE_ARRAY(c, rhLN, _NhLN);
+
+    STATE_ARRAY(c, glbSpkCntLHI, 1);
+    STATE_ARRAY(c, glbSpkLHI, _NLHI);
+    STATE_ARRAY(c, sTLHI, _NLHI);
+    STATE_ARRAY(c, VLHI, _NLHI);
+    STATE_ARRAY(c, mLHI, _NLHI);
+    STATE_ARRAY(c, hLHI, _NLHI);
+    STATE_ARRAY(c, nLHI, _NLHI);
+    STATE_ARRAY(c, rLHI, _NLHI);
+
+    STATE_ARRAY(c, inSynORNPN, _NPN);
+    STATE_ARRAY(c, inSynORNPN1, _NPN);
+    STATE_ARRAY(c, inSynhLNPN, _NPN);
+    STATE_ARRAY(c, inSynORNhLN, _NhLN);
+    STATE_ARRAY(c, inSynPNhLN, _NhLN);
+    STATE_ARRAY(c, inSynhLNhLN, _NhLN);
+    STATE_ARRAY(c, inSynPNLHI, _NLHI);
+
+    STATE_ARRAY(c, pORNPN1, CORNPN1.connN);
+    STATE_ARRAY(c, grawORNPN1, CORNPN1.connN);
+    STATE_ARRAY(c, gORNPN1, CORNPN1.connN);
+    STATE_ARRAY(c, lastupdateORNPN1, CORNPN1.connN);
+    // the ORNPN1 plasticity mode of the writer: only the lazy one keeps lastupdateORNPN1
+#ifndef CPU_ONLY
+    int lazy= 0;
+    c.data("lazyPlasticity", &lazy, sizeof(int), false);
+#else
+    int lazy= lazyPlasticity;
+    bool hasMode= c.data("lazyPlasticity", &lazy, sizeof(int), false);
+    // the R segment of the lazy plasticity, so that a restored run continues bit for bit
+    int open= lzR.open;
+    bool hasSegment= c.data("lzR.open", &open, sizeof(int), false);
+    if (hasSegment) {
+	lzR.open= open;
+	STATE_VALUE(c, lzR.ts);
+	STATE_VALUE(c, lzR.Rs);
+	STATE_VALUE(c, lzR.Rt);
+	STATE_VALUE(c, lzLastT);
+    }
+    if (!hasMode) lazy= hasSegment; // files from before the mode was stored
+    if (c.reading && (!lazy || !hasSegment)) {
+	// p, graw and g are up to date at t; the lazy integration starts there,
+	// with a new R segment opened by the first step
+	for (unsigned int j= 0; j < CORNPN1.connN; j++) lastupdateORNPN1[j]= t;
+	lzR.open= false;
+	lzR.Rt= base_RORNPN1+reward;
+	lzLastT= t-DT;
+    }
+#endif
+}
+
+// the sizes a state file must agree with
+#define STATE_DIMS 8
+static void state_dims(uint32_t *d, unsigned int protoN)
+{
+    d[0]= sizeof(scalar);
+    d[1]= _NORN;
+    d[2]= _NPN;
+    d[3]= _NhLN;
+    d[4]= _NLHI;
+    d[5]= _nGLO;
+    d[6]= CORNPN1.connN;
+    d[7]= protoN;
+}
+
+void AL::write_state(string name)
+{
+#ifndef CPU_ONLY
+    if (device == GPU) {
+	copyStateFromDevice();
+    }
+#else
+    syncStateCPU();
+#endif
+    checkpoint c;
+    c.startWrite();
+    uint32_t dims[STATE_DIMS];
+    state_dims(dims, proto.size());
+    c.data("dims", dims, sizeof(dims));
+    uint64_t h= network_hash();
+    c.data("network", &h, sizeof(h));
+    c.data("seed", &seed, sizeof(seed));
+    state_io(c);
+    if (!c.write(name)) {
+	cerr << "error writing state file " << name << " ... exiting" << endl;
+	exit(1);
+    }
+    cerr << "% state written to " << name << " at t= " << t << endl;
+}
+
+// call after enable(): restores the state written by write_state() into the same network
+void AL::read_state(string name)
+{
+    checkpoint c;
+    string err;
+    if (!c.read(name, err)) {
+	cerr << err << " ... exiting" << endl;
+	exit(1);
+    }
+    uint32_t dims[STATE_DIMS], fdims[STATE_DIMS];
+    state_dims(dims, proto.size());
+    c.data("dims", fdims, sizeof(fdims));
+    for (int i= 0; i < STATE_DIMS-1; i++) {
+	if (dims[i] != fdims[i]) {
+	    cerr << "state file " << name << " is for a different model size ... exiting" << endl;
+	    exit(1);
+	}
+    }
+    if (dims[STATE_DIMS-1] != fdims[STATE_DIMS-1]) {
+	cerr << "% warning: state file " << name << " was written with a protocol of " << fdims[STATE_DIMS-1] << " items, this one has " << dims[STATE_DIMS-1] << endl;
+    }
+    uint64_t h;
+    c.data("network", &h, sizeof(h));
+    if (h != network_hash()) {
+	cerr << "state file " << name << " is for a different network (seed or connectivity) ... exiting" << endl;
+	exit(1);
+    }
+    unsigned int fseed;
+    c.data("seed", &fseed, sizeof(fseed));
+    if (fseed != seed) {
+	cerr << "% warning: state file " << name << " was written with seed " << fseed << endl;
+    }
+    state_io(c);
+    if (iProto > (int) proto.size()) {
+	cerr << "state file " << name << " is past the end of the protocol ... exiting" << endl;
+	exit(1);
+    }
+#ifndef CPU_ONLY
+    if (device == GPU) {
+	copyStateToDevice();
+	unsigned int size= _nGLO*12*sizeof(scalar);
+	CHECK_CUDA_ERRORS(cudaMemcpy(d_theKK, theKK, size, cudaMemcpyHostToDevice));
+	CHECK_CUDA_ERRORS(cudaMemcpy(d_directinput, directinput, _NLHI*sizeof(double), cudaMemcpyHostToDevice));
+    }
+#else
+    restoreStateCPU();
+#endif
+    cerr << "% state read from " << name << ": t= " << t << ", protocol item " << iProto << endl;
+}
+
 int AL::continues() 
 {
     return (iProto < proto.size());
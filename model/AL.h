@@ -21,26 +21,43 @@
 
 #include <fstream>
 #include <vector>
+#include "spikeio.h"
+#include "odorbank.h"
+#include "conbin.h"
+#include "ALcheckpoint.h"
 
 #include "ALmodel.cc"
+#ifdef CPU_ONLY
+#include "cpu/runner_cpu.cc"
+#else
 #include "ALmodel_CODE/runner.cc"
+#endif
 
 union value_t {
     double d;
     int i;
 };
 
+//! protocol events, compiled from the lines of a .proto file
+enum protoOp {PROTO_ODOR_ON, PROTO_ODOR_OFF, PROTO_REWARD, PROTO_INPUT};
+
 class proto_item {
 public:
     double t;
-    string action;
-    union value_t value[4];
+    int op; //!< a protoOp
+    union value_t value[4]; //!< odor: slot, odor, log10 concentration, 1/-1 (on/off); reward: value; input: neuron, value
+    int line; //!< in the protocol file
 };
 
 class AL {
+  friend class ALensemble;
  protected:
     NNmodel model;
-  vector<vector<vector<double> > > odorPP;
+  odorBank bank;
+  conFile conn; //!< connFile, mapped on first use
+  string odorDir, odorExt;
+  vector<double> odorPP; //!< text odors [odor][glomerulus][5], each read on first use
+  vector<char> odorRead;
   unsigned int device;
   scalar *theKK, *d_theKK;
   int iT;
@@ -49,12 +66,26 @@ class AL {
   double reward;
   double *directinput,*directinput2, *d_directinput;
   int iProto;
+  vector<unsigned int> stBuf;
+  vector<double> fsBuf;
+  vector<scalar> blockR; //!< R during the steps of a block
 
  public:
+  // the steps of the last run_until(): t after each step, the number of
+  // spikes of each step, their ids (as spike_ids()) and the spike counts of
+  // ORNs, PNs, hLNs and LHIs
+  vector<double> blockT;
+  vector<unsigned int> blockSpkN, blockSpk;
+  unsigned long blockCount[4];
+
   AL(unsigned int);
   ~AL();
   void enable();
   void readOdors(int, string, string);
+  const double *odor(unsigned int);
+  void load_odors(const vector<proto_item> &);
+  bool conn_group(const char *, SparseProjection &, scalar *&, unsigned int, unsigned int, void (*)(unsigned int), bool copy= false);
+  void write_conn(string);
   void connect_ORN_PN1();
 	void randomize_V();
   void connect_ORN_PN();
@@ -65,19 +96,32 @@ class AL {
   void connect_hLN_hLN();
   void initialize_ORN_seeds();
   void initialize_input();
-  void read_protocol(ifstream &);
+  static void parse_protocol(istream &, vector<proto_item> &, string src= "protocol");
+  void read_protocol(ifstream &, string src= "protocol");
+  void switch_protocol(ifstream &, string src= "protocol");
+  //! time of the next protocol event (HUGE_VAL: none)
+  double next_event() { return (iProto < (int) proto.size()) ? proto[iProto].t : HUGE_VAL; }
   void run();
+  unsigned int run_until(double);
   void protocol_handler(double);
   void allocate_direct_input();
   void set_directInput(int, double);
   void add_input(unsigned int, double, unsigned int);
   void remove_input(unsigned int);
   void output_state(ostream &);
+  void full_state_values(vector<double> &);
+  void full_state_names(vector<string> &);
   void output_full_state(ostream &);
   void output_matlab_helper_full(string);
   void output_LN(ostream &);
   void output_ORN(ostream &);
   void output_state_st(ostream &);
+  void output_state_st(spikeWriter &);
+  void spike_ids(vector<unsigned int> &);
+  uint64_t network_hash();
+  void state_io(checkpoint &);
+  void write_state(string);
+  void read_state(string);
   int continues();
 };
 
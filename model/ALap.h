@@ -16,9 +16,11 @@
 
 #include <string>
 #include <sstream>
+#ifndef CPU_ONLY
 #include "toString.h"
+#endif
 
-#define AP_NO 96
+#define AP_NO 127
 
 enum APTypes {AP_FLOAT, AP_DOUBLE, AP_INT, AP_STRING};
 
@@ -95,6 +97,11 @@ void setup_AP() {
   add_array_AP(myhLNPN_ini, toString("myhLNPN_ini"), AP_DOUBLE, n, SYN1_IVARNO);
   // hLNPN_post parameters
   add_array_AP(myhLNPN_post_p, toString("myhLNPN_post_p"), AP_DOUBLE, n, POSTSYN1_PNO);
+  // hLNhLN initial variables
+  add_array_AP(myhLNhLN_ini, toString("myhLNhLN_ini"), AP_DOUBLE, n, SYN1_IVARNO);
+  AP[n]= (void *) &myhLNhLN_gjitter;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("myhLNhLN_gjitter");
   // PNLHI initial variables
   add_array_AP(myPNLHI_ini, toString("myPNLHI_ini"), AP_DOUBLE, n, SYN1_IVARNO);
   // PNLHI_post parameters
@@ -126,9 +133,87 @@ void setup_AP() {
   AP[n]= &writeState;
   AP_TYPE[n]= AP_INT;
   AP_NAME[n++]= toString("writeState");
+  AP[n]= &writeStateInterval;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("writeStateInterval");
+  AP[n]= &branchTime;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("branchTime");
+  AP[n]= &branchFile;
+  AP_TYPE[n]= AP_STRING;
+  AP_NAME[n++]= toString("branchFile");
+  AP[n]= &branchJobs;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("branchJobs");
+  AP[n]= &ensembleFile;
+  AP_TYPE[n]= AP_STRING;
+  AP_NAME[n++]= toString("ensembleFile");
   AP[n]= &seed;
   AP_TYPE[n]= AP_INT;
   AP_NAME[n++]= toString("seed");
+  AP[n]= &nThreads;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("nThreads");
+  AP[n]= &hhKernel;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("hhKernel");
+  AP[n]= &hhKinetics;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("hhKinetics");
+  AP[n]= &hhTableVmin;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("hhTableVmin");
+  AP[n]= &hhTableVmax;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("hhTableVmax");
+  AP[n]= &hhTableDV;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("hhTableDV");
+  AP[n]= &lazyPlasticity;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("lazyPlasticity");
+  AP[n]= &hLNhLNExact;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("hLNhLNExact");
+  AP[n]= &ornRNG;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("ornRNG");
+  AP[n]= &connRNG;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("connRNG");
+  AP[n]= &spikeFormat;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("spikeFormat");
+  AP[n]= &spikeIndex;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("spikeIndex");
+  AP[n]= &writeSpikes;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("writeSpikes");
+  AP[n]= &sdfTau;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("sdfTau");
+  AP[n]= &sdfDt;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("sdfDt");
+  AP[n]= &rateBin;
+  AP_TYPE[n]= AP_DOUBLE;
+  AP_NAME[n++]= toString("rateBin");
+  AP[n]= &traceFormat;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("traceFormat");
+  AP[n]= &traceBytes;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("traceBytes");
+  AP[n]= &asyncOutput;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("asyncOutput");
+  AP[n]= &asyncFrames;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("asyncFrames");
+  AP[n]= &asyncFrameKB;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("asyncFrameKB");
   AP[n]= &odorPath;
   AP_TYPE[n]= AP_STRING;
   AP_NAME[n++]= toString("odorPath");
@@ -138,6 +223,15 @@ void setup_AP() {
   AP[n]= &LNPNsynFile;
   AP_TYPE[n]= AP_STRING;
   AP_NAME[n++]= toString("LNPNsynFile");
+  AP[n]= &LNPNrank;
+  AP_TYPE[n]= AP_INT;
+  AP_NAME[n++]= toString("LNPNrank");
+  AP[n]= &connFile;
+  AP_TYPE[n]= AP_STRING;
+  AP_NAME[n++]= toString("connFile");
+  AP[n]= &connOutFile;
+  AP_TYPE[n]= AP_STRING;
+  AP_NAME[n++]= toString("connOutFile");
   
   cerr << "% parameter number " << n << " " << apn << endl;
   assert(n == apn);
@@ -0,0 +1,162 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#include "ALcheckpoint.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+uint64_t fnv1a(const void *p, size_t n, uint64_t h)
+{
+  const unsigned char *c= (const unsigned char *) p;
+  for (size_t i= 0; i < n; i++) {
+    h^= c[i];
+    h*= 1099511628211ULL;
+  }
+  return h;
+}
+
+checkpoint::checkpoint(): sectionN(0), reading(false), version(ALCKPT_VERSION)
+{
+}
+
+void checkpoint::startWrite()
+{
+  reading= false;
+  version= ALCKPT_VERSION;
+  sectionN= 0;
+  buf.clear();
+  sections.clear();
+  buf.insert(buf.end(), ALCKPT_MAGIC, ALCKPT_MAGIC+8);
+  uint32_t h[2]= {ALCKPT_VERSION, 0};
+  buf.insert(buf.end(), (const char *) h, (const char *) (h+2));
+}
+
+//! write the collected sections to name; goes through name.tmp so that an interrupted write leaves the previous file intact
+bool checkpoint::write(string name)
+{
+  uint32_t n= sectionN;
+  memcpy(&buf[12], &n, sizeof(uint32_t));
+  uint64_t sum= fnv1a(&buf[0], buf.size());
+  string tmp= name+".tmp";
+  ofstream os(tmp.c_str(), ios::binary);
+  os.write(&buf[0], buf.size());
+  os.write((const char *) &sum, sizeof(uint64_t));
+  os.write(ALCKPT_END, 8);
+  os.close();
+  if (!os.good()) return false;
+  return (rename(tmp.c_str(), name.c_str()) == 0);
+}
+
+//! read and verify the file name; err says what is wrong if it returns false
+bool checkpoint::read(string name, string &err)
+{
+  reading= true;
+  sections.clear();
+  ifstream is(name.c_str(), ios::binary | ios::ate);
+  if (!is.good()) {
+    err= "cannot open "+name;
+    return false;
+  }
+  size_t size= is.tellg();
+  if (size < 32) {
+    err= name+" is too short";
+    return false;
+  }
+  buf.resize(size);
+  is.seekg(0);
+  is.read(&buf[0], size);
+  if (!is.good()) {
+    err= "error reading "+name;
+    return false;
+  }
+  if ((memcmp(&buf[0], ALCKPT_MAGIC, 8) != 0) || (memcmp(&buf[size-8], ALCKPT_END, 8) != 0)) {
+    err= name+" is not a state file";
+    return false;
+  }
+  uint64_t sum;
+  memcpy(&sum, &buf[size-16], sizeof(uint64_t));
+  if (sum != fnv1a(&buf[0], size-16)) {
+    err= "checksum error in "+name;
+    return false;
+  }
+  uint32_t h[2];
+  memcpy(h, &buf[8], 2*sizeof(uint32_t));
+  version= h[0];
+  if (version > ALCKPT_VERSION) {
+    err= name+" was written by a newer version of ALsim";
+    return false;
+  }
+  sectionN= h[1];
+  size_t pos= 16;
+  for (unsigned int i= 0; i < sectionN; i++) {
+    if (pos+ALCKPT_NAMELEN+8 > size-16) {
+      err= name+" is truncated";
+      return false;
+    }
+    string s(&buf[pos], strnlen(&buf[pos], ALCKPT_NAMELEN));
+    pos+= ALCKPT_NAMELEN;
+    uint64_t bytes;
+    memcpy(&bytes, &buf[pos], sizeof(uint64_t));
+    pos+= sizeof(uint64_t);
+    if (pos+bytes > size-16) {
+      err= name+" is truncated";
+      return false;
+    }
+    sections[s]= make_pair(pos, (size_t) bytes);
+    pos+= bytes;
+  }
+  return true;
+}
+
+bool checkpoint::has(const char *name)
+{
+  return (sections.find(name) != sections.end());
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Append the bytes at p as section name, or, when reading, copy
+  section name to p. A missing required section or one of the wrong size
+  is fatal; a missing optional one leaves p unchanged and returns false.
+ */
+//--------------------------------------------------------------------------
+
+bool checkpoint::data(const char *name, void *p, size_t bytes, bool required)
+{
+  if (!reading) {
+    char s[ALCKPT_NAMELEN];
+    memset(s, 0, ALCKPT_NAMELEN);
+    strncpy(s, name, ALCKPT_NAMELEN-1);
+    buf.insert(buf.end(), s, s+ALCKPT_NAMELEN);
+    uint64_t n= bytes;
+    buf.insert(buf.end(), (const char *) &n, (const char *) (&n+1));
+    buf.insert(buf.end(), (const char *) p, (const char *) p+bytes);
+    sectionN++;
+    return true;
+  }
+  map<string, pair<size_t, size_t> >::iterator it= sections.find(name);
+  if (it == sections.end()) {
+    if (!required) return false;
+    cerr << "state file has no " << name << " ... exiting" << endl;
+    exit(1);
+  }
+  if (it->second.second != bytes) {
+    cerr << "state file: " << name << " has " << it->second.second << " bytes, expected " << bytes << " ... exiting" << endl;
+    exit(1);
+  }
+  memcpy(p, &buf[it->second.first], bytes);
+  return true;
+}
@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file ALcheckpoint.h
+
+\brief Binary snapshot files of the working state of ALsim (readState,
+writeState).
+
+Layout (byte order of the machine):
+header    "ALSTATE_", uint32 version, uint32 number of sections
+sections  char name[24] (zero padded), uint64 bytes, the bytes
+trailer   uint64 FNV-1a checksum of everything before it, "ALSTEND_"
+
+Sections are found by name, so later versions can add sections that older
+readers skip. The same list of sections is used for writing and reading
+(checkpoint::data() copies in the direction of the file), which keeps the
+two in step.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ALCHECKPOINT_H
+#define ALCHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+using namespace std;
+
+#define ALCKPT_MAGIC "ALSTATE_"
+#define ALCKPT_END "ALSTEND_"
+#define ALCKPT_VERSION 1
+#define ALCKPT_NAMELEN 24
+
+//! FNV-1a hash of n bytes at p, continuing from h
+uint64_t fnv1a(const void *p, size_t n, uint64_t h= 14695981039346656037ULL);
+
+class checkpoint
+{
+ private:
+  vector<char> buf;
+  map<string, pair<size_t, size_t> > sections; //!< offset and size of each section when reading
+  unsigned int sectionN;
+
+ public:
+  bool reading;
+  unsigned int version;
+
+  checkpoint();
+  void startWrite();
+  bool write(string);
+  bool read(string, string &);
+  bool has(const char *);
+  bool data(const char *, void *, size_t, bool required= true);
+};
+
+#endif
@@ -0,0 +1,229 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#include "ALensemble.h"
+#include <sys/stat.h>
+
+//--------------------------------------------------------------------------
+/*! \brief Read the ensemble file name, build every network and open its
+  output files <directory>/<base>.out.*; al must be set up (odors read,
+  enabled) as for a single run
+ */
+//--------------------------------------------------------------------------
+
+ALensemble::ALensemble(AL &_al, string name, string base): al(_al)
+{
+  ifstream is(name.c_str());
+  if (!is.good()) {
+    cerr << "could not open ensemble file " << name << " ... exiting" << endl;
+    exit(1);
+  }
+  string line;
+  while (getline(is, line)) {
+    stringstream ls(line);
+    string s, d, p;
+    if (!(ls >> s) || (s[0] == '#')) continue;
+    if (!(ls >> d >> p)) {
+      cerr << "ensemble file " << name << ": expected <seed> <directory> <protocol> in \"" << line << "\" ... exiting" << endl;
+      exit(1);
+    }
+    member *x= new member;
+    x->seed= atoi(s.c_str());
+    x->dir= d;
+    ifstream pis(p.c_str());
+    if (!pis.good()) {
+      cerr << "could not open protocol " << p << " ... exiting" << endl;
+      exit(1);
+    }
+    AL::parse_protocol(pis, x->proto, p);
+    al.load_odors(x->proto);
+    x->iProto= 0;
+    x->reward= 0.0;
+    x->theKK.assign(_nGLO*12, 0.0);
+    for (int i= 0; i < 4; i++) x->sum[i]= 0;
+    x->done= x->proto.empty();
+    m.push_back(x);
+  }
+  if (m.empty()) {
+    cerr << "ensemble file " << name << " lists no networks ... exiting" << endl;
+    exit(1);
+  }
+  unsigned int K= m.size();
+  ensembleAllocate(E, K);
+
+  // build each network exactly like main() does for a single run
+  unsigned int seed0= seed;
+  vector<scalar *> kk0(kkORN, kkORN+_NORN); // initialize() clears them
+  for (unsigned int k= 0; k < K; k++) {
+    seed= m[k]->seed;
+    initialize();
+    al.initialize_ORN_seeds();
+    R.seedrand((unsigned long) seed, (unsigned long) seed+1, (unsigned long) seed+2);
+    RG.seedrand((unsigned long) seed, (unsigned long) seed+1, (unsigned long) seed+2);
+    al.connect_ORN_PN1();
+    al.connect_ORN_PN();
+    al.connect_ORN_hLN();
+    al.connect_PN_hLN();
+    al.connect_PN_LHI();
+    al.connect_hLN_PN(LNPNsynFile);
+    al.connect_hLN_hLN();
+    al.randomize_V();
+    ensembleLoad(E, k, m[k]->theKK.data(), (uint64_t) seed);
+    E.R[E.slot[k]]= base_RORNPN1;
+  }
+  seed= seed0;
+  for (int i= 0; i < _NORN; i++) kkORN[i]= kk0[i];
+
+  for (unsigned int k= 0; k < K; k++) {
+    member &x= *m[k];
+    mkdir(x.dir.c_str(), 0755);
+    string fname= x.dir+"/"+base;
+    if (spikeFormat != 1) {
+      x.stos.open((fname+".out.st").c_str());
+      x.stos.precision(5);
+    }
+    if (spikeFormat > 0) x.stbw.open(fname+".out.stb", _NPN+_NhLN+_NLHI, DT, 5000, spikeIndex);
+    x.out= new ALoutput(NULL, NULL, (spikeFormat != 1) ? &x.stos : NULL, (spikeFormat > 0) ? &x.stbw : NULL, false, 0, 0);
+  }
+  cerr << "% ensemble of " << K << " networks from " << name << endl;
+}
+
+ALensemble::~ALensemble()
+{
+  for (unsigned int k= 0; k < m.size(); k++) {
+    finish(k);
+    delete m[k];
+  }
+}
+
+// as AL::add_input() and AL::remove_input(), for network k
+void ALensemble::add_input(unsigned int k, unsigned int od, double c, unsigned int pos)
+{
+  const double *pp= al.odor(od);
+  scalar cc= pow(10.0,c);
+  for (int i= 0; i < _nGLO; i++) {
+    scalar *kk= m[k]->theKK.data()+i*12+pos*6;
+    for (int l= 0; l < 5; l++) kk[l]= pp[i*5+l];
+    kk[5]= cc;
+  }
+  ensembleInputChanged(E, k);
+}
+
+void ALensemble::remove_input(unsigned int k, unsigned int pos)
+{
+  scalar *theKK= m[k]->theKK.data();
+  for (int i= 0; i < _nGLO; i++) {
+    theKK[i*12+pos*6+5]= 0.0;
+  }
+  ensembleInputChanged(E, k);
+}
+
+// as AL::protocol_handler(), for network k
+void ALensemble::protocol_handler(unsigned int k, double t)
+{
+  member &x= *m[k];
+  while ((x.iProto < (int) x.proto.size()) && (t >= x.proto[x.iProto].t)) {
+    const proto_item &p= x.proto[x.iProto];
+    switch (p.op) {
+    case PROTO_ODOR_ON:
+      add_input(k, p.value[1].i, p.value[2].d, p.value[0].i);
+      break;
+    case PROTO_ODOR_OFF:
+      remove_input(k, p.value[0].i);
+      break;
+    case PROTO_REWARD:
+      x.reward= p.value[0].d;
+      ensembleRewardChanged(E, k, base_RORNPN1+x.reward);
+      break;
+    case PROTO_INPUT:
+      E.input[E.slot[k]*cpuNLHI+p.value[0].i]= p.value[1].d;
+      break;
+    }
+#ifdef DEBUG
+    cerr << "# " << x.dir << " t: " << t << " - " << protoOpName[p.op] << endl;
+#endif
+    x.iProto++;
+  }
+}
+
+void ALensemble::finish(unsigned int k)
+{
+  member &x= *m[k];
+  if (x.out == NULL) return;
+  x.out->finish();
+  delete x.out;
+  x.out= NULL;
+  if (spikeFormat != 1) x.stos.close();
+  if (spikeFormat > 0) x.stbw.close();
+  cerr << "% " << x.dir << " (seed " << x.seed << "): " << x.sum[0] << " ORN " << x.sum[1] << " PN " << x.sum[2] << " LN " << x.sum[3] << " LHI spikes." << endl;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Run all networks until every protocol has ended. Once the
+  protocol of a network has ended it leaves the batch (ensembleFinish())
+  and writes no more output.
+ */
+//--------------------------------------------------------------------------
+
+void ALensemble::run()
+{
+  const unsigned int K= E.K;
+  unsigned int running= 0;
+  for (unsigned int k= 0; k < K; k++) {
+    if (m[k]->done) {
+      ensembleFinish(E, k);
+      finish(k);
+    }
+    else running++;
+  }
+  CStopWatch w;
+  w.startTimer();
+  unsigned long steps= 0, networkSteps= 0;
+  t= 0.0;
+  while (running > 0) {
+    for (unsigned int k= 0; k < K; k++) {
+      if (m[k]->done) continue;
+      protocol_handler(k, t);
+      scalar &Rk= E.R[E.slot[k]];
+      Rk+= (base_RORNPN1+m[k]->reward-Rk)/RORNPN1_tau*DT;
+    }
+    ensembleStep(E, t);
+    steps++;
+    networkSteps+= running;
+    t= steps*DT;
+    for (unsigned int k= 0; k < K; k++) {
+      member &x= *m[k];
+      if (x.done) continue;
+      unsigned int s= E.slot[k];
+      ids.clear();
+      for (unsigned int i= 0; i < E.spkNPN[s]; i++) ids.push_back(E.spkPN[s*cpuNPN+i]);
+      for (unsigned int i= 0; i < E.spkNhLN[s]; i++) ids.push_back(E.spkhLN[s*cpuNhLN+i]+_NPN);
+      for (unsigned int i= 0; i < E.spkNLHI[s]; i++) ids.push_back(E.spkLHI[s*cpuNLHI+i]+_NPN+_NhLN);
+      x.out->spikes(t, ids);
+      x.sum[0]+= E.spkNORN[s];
+      x.sum[1]+= E.spkNPN[s];
+      x.sum[2]+= E.spkNhLN[s];
+      x.sum[3]+= E.spkNLHI[s];
+      if (x.iProto >= (int) x.proto.size()) {
+	x.done= true;
+	ensembleFinish(E, k);
+	finish(k);
+	running--;
+      }
+    }
+  }
+  w.stopTimer();
+  double tme= w.getElapsedTime();
+  cerr << "elapsed time: " << tme << ", " << K << " networks, " << steps << " steps, " << networkSteps*DT/1000.0/tme << " network seconds per second" << endl;
+}
@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file ALensemble.h
+
+\brief Ensemble mode of ALsim (ensembleFile): many networks with their own
+seeds and protocols simulated together by the batched CPU engine of
+cpu/ensemble_cpu.cc.
+
+ensembleFile has a line "<seed> <output directory> <protocol file>" per
+network. Each network is built with the AL connect functions as ALsim
+would build it for that seed, and keeps its own odor input, reward, R and
+direct input. Its spikes go to <output directory>/<base>.out.st (or .stb
+according to spikeFormat). The odors are read only once.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ALENSEMBLE_H
+#define ALENSEMBLE_H
+
+#include "AL.h"
+#include "ALoutput.h"
+#include "cpu/ensemble_cpu.cc"
+
+class ALensemble
+{
+ private:
+  struct member {
+    unsigned int seed;
+    string dir;
+    vector<proto_item> proto;
+    int iProto;
+    double reward;
+    vector<scalar> theKK;
+    ofstream stos;
+    spikeWriter stbw;
+    ALoutput *out;
+    unsigned int sum[4]; //!< ORN, PN, hLN and LHI spikes
+    bool done;
+  };
+
+  AL &al;
+  ensembleCPU E;
+  vector<member *> m;
+  vector<unsigned int> ids;
+
+  void add_input(unsigned int, unsigned int, double, unsigned int);
+  void remove_input(unsigned int, unsigned int);
+  void protocol_handler(unsigned int, double);
+  void finish(unsigned int);
+
+ public:
+  ALensemble(AL &, string, string);
+  ~ALensemble();
+  void run();
+};
+
+#endif
@@ -24,14 +24,23 @@
 //--------------------------------------------------------------------------
 
 #define DT 0.02 //!< global time step at which the simulation will run
+#ifdef CPU_ONLY
+#include "cpu/genn_cpu.h"
+#else
 #include "modelSpec.h"
 #include "modelSpec.cc"
+#endif
+#ifdef CPU_ONLY
+string INPUTFILE; //!< <directory>/<basename>.in from the arguments of ALsim; the CPU build reads it at runtime
+#else
 #include "settings.h"
+#endif
 #include "ALsim.h"
 
 //uncomment the following line to turn on timing measures
 //#define TIMING
-#define DEBUG   
+//uncomment the following line to turn on debugging output
+//#define DEBUG
 
 unsigned int seed= 1234;
 int _nGLO= 30;
@@ -283,6 +292,7 @@ double myhLNPN_post_p[POSTSYN1_PNO]= {
 double myhLNhLN_ini[SYN1_IVARNO]= {
   1.2e-03// 0 - g: conductance
 };
+double myhLNhLN_gjitter= 0.0; // in percent of g; 0 keeps all weights equal (uniform lateral inhibition)
 double *myhLNhLN_p= NULL;
 
 double *myhLNhLN_post_ini= NULL;
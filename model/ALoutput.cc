@@ -0,0 +1,189 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#include "ALoutput.h"
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+
+//--------------------------------------------------------------------------
+/*! \brief Set up the output to the .out.cmp stream cmp, the binary
+  .out.cmpb writer cmpb, the .out.st stream st and the binary spike writer
+  stb (each may be NULL); with async the
+  records go through frameN frames of frameBytes bytes to a writer thread
+ */
+//--------------------------------------------------------------------------
+
+ALoutput::ALoutput(ostream *_cmp, matWriter *_cmpb, ostream *_st, spikeWriter *_stb, bool _async, unsigned int _frameN, size_t frameBytes): cmp(_cmp), st(_st), cmpb(_cmpb), stb(_stb), async(_async), cur(NULL), blockedTime(0.0), blockedN(0), frameN(0)
+{
+#ifndef ALOUTPUT_ASYNC
+  if (async) {
+    cerr << "% asynchronous output needs C++11, writing synchronously" << endl;
+    async= false;
+  }
+#endif
+  if (!async) return;
+#ifdef ALOUTPUT_ASYNC
+  if (_frameN < 2) _frameN= 2;
+  frames.resize(_frameN);
+  full= new spscQueue<frame *>(_frameN);
+  empty= new spscQueue<frame *>(_frameN);
+  for (unsigned int i= 0; i < _frameN; i++) {
+    frames[i].data.resize(frameBytes);
+    frames[i].used= 0;
+    if (i > 0) empty->push(&frames[i]);
+  }
+  cur= &frames[0];
+  done= false;
+  writer= std::thread(&ALoutput::writerLoop, this);
+#endif
+}
+
+ALoutput::~ALoutput()
+{
+  finish();
+}
+
+void ALoutput::writeSpikes(double t, const unsigned int *id, unsigned int n)
+{
+  if (st != NULL) {
+    for (unsigned int i= 0; i < n; i++) *st << t << " " << id[i] << '\n';
+  }
+  if (stb != NULL) stb->write(t, id, n);
+}
+
+void ALoutput::writeState(double t, const double *v, unsigned int n)
+{
+  if (cmp != NULL) {
+    *cmp << t << " ";
+    for (unsigned int i= 0; i < n; i++) *cmp << v[i] << " ";
+    *cmp << endl;
+  }
+  if (cmpb != NULL) cmpb->row(t, v);
+}
+
+void ALoutput::writeFrame(frame *f)
+{
+  size_t pos= 0;
+  while (pos < f->used) {
+    recordHead h;
+    memcpy(&h, &f->data[pos], sizeof(recordHead));
+    pos+= sizeof(recordHead);
+    if (h.type == SPIKES) {
+      writeSpikes(h.t, (const unsigned int *) &f->data[pos], h.n);
+      pos+= h.n*sizeof(unsigned int);
+    }
+    else {
+      writeState(h.t, (const double *) &f->data[pos], h.n);
+      pos+= h.n*sizeof(double);
+    }
+  }
+  f->used= 0;
+}
+
+void ALoutput::writerLoop()
+{
+#ifdef ALOUTPUT_ASYNC
+  frame *f;
+  while (true) {
+    if (full->pop(f)) {
+      writeFrame(f);
+      empty->push(f);
+    }
+    else if (done.load(std::memory_order_acquire)) {
+      // finish() pushes the last frame before it sets done
+      while (full->pop(f)) writeFrame(f);
+      return;
+    }
+    else usleep(100);
+  }
+#endif
+}
+
+//! an empty frame; waits for the writer if there is none (backpressure)
+ALoutput::frame *ALoutput::getEmpty()
+{
+  frame *f= NULL;
+#ifdef ALOUTPUT_ASYNC
+  if (empty->pop(f)) return f;
+  CStopWatch w;
+  w.startTimer();
+  blockedN++;
+  while (!empty->pop(f)) usleep(50);
+  w.stopTimer();
+  blockedTime+= w.getElapsedTime();
+#endif
+  return f;
+}
+
+//! append a record to the current frame; hands the frame on when it is full
+void ALoutput::put(int type, double t, const void *p, unsigned int n, size_t bytes)
+{
+  size_t need= sizeof(recordHead)+bytes;
+  if (cur->used+need > cur->data.size()) {
+#ifdef ALOUTPUT_ASYNC
+    if (cur->used > 0) {
+      full->push(cur);
+      frameN++;
+      cur= getEmpty();
+    }
+#endif
+    if (need > cur->data.size()) cur->data.resize(need);
+  }
+  recordHead h;
+  h.type= type;
+  h.n= n;
+  h.t= t;
+  memcpy(&cur->data[cur->used], &h, sizeof(recordHead));
+  memcpy(&cur->data[cur->used+sizeof(recordHead)], p, bytes);
+  cur->used+= need;
+}
+
+void ALoutput::spikes(double t, const vector<unsigned int> &id)
+{
+  spikes(t, id.data(), id.size());
+}
+
+void ALoutput::spikes(double t, const unsigned int *id, unsigned int n)
+{
+  if ((n == 0) || ((st == NULL) && (stb == NULL))) return;
+  if (async) put(SPIKES, t, id, n, n*sizeof(unsigned int));
+  else writeSpikes(t, id, n);
+}
+
+void ALoutput::state(double t, const vector<double> &v)
+{
+  assert((cmp != NULL) || (cmpb != NULL));
+  if (async) put(STATE, t, v.data(), v.size(), v.size()*sizeof(double));
+  else writeState(t, v.data(), v.size());
+}
+
+//! write everything that is still buffered and stop the writer thread
+void ALoutput::finish()
+{
+#ifdef ALOUTPUT_ASYNC
+  if (async) {
+    if (cur->used > 0) {
+      while (!full->push(cur)) usleep(50);
+      frameN++;
+    }
+    done.store(true, std::memory_order_release);
+    writer.join();
+    delete full;
+    delete empty;
+    async= false;
+    cerr << "% asynchronous output: " << frameN << " frames, simulation blocked " << blockedN << " times for " << blockedTime << " s" << endl;
+  }
+#endif
+}
@@ -0,0 +1,123 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file ALoutput.h
+
+\brief Output of spikes and state traces of ALsim (text and/or binary),
+optionally on a background thread.
+
+The simulation thread appends records (spike ids of a step, values of a
+.out.cmp line) to a preallocated frame. Full frames are handed to the
+writer thread over a lock-free single producer / single consumer queue and
+come back over a second one once written. There are asyncFrames frames of
+asyncFrameKB kB, so memory is bounded: if all frames are full the
+simulation thread waits for the writer (backpressure) and the time it
+waits is counted. With asyncOutput 0 the records are written directly.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ALOUTPUT_H
+#define ALOUTPUT_H
+
+#include <iostream>
+#include <vector>
+#if __cplusplus >= 201103L
+#include <thread>
+#include <atomic>
+#define ALOUTPUT_ASYNC
+#endif
+#include "spikeio.h"
+#include "matbin.h"
+
+using namespace std;
+
+#ifdef ALOUTPUT_ASYNC
+//! lock-free queue for one producer and one consumer thread
+template <class T>
+class spscQueue
+{
+ private:
+  vector<T> buf;
+  std::atomic<size_t> head, tail;
+
+ public:
+  explicit spscQueue(size_t n): buf(n+1), head(0), tail(0) { }
+
+  bool push(const T &x) {
+    size_t t= tail.load(std::memory_order_relaxed);
+    size_t next= (t+1) % buf.size();
+    if (next == head.load(std::memory_order_acquire)) return false;
+    buf[t]= x;
+    tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &x) {
+    size_t h= head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;
+    x= buf[h];
+    head.store((h+1) % buf.size(), std::memory_order_release);
+    return true;
+  }
+};
+#endif
+
+class ALoutput
+{
+ private:
+  enum recordType {SPIKES, STATE};
+  struct recordHead {
+    int type;
+    unsigned int n;
+    double t;
+  };
+  struct frame {
+    vector<char> data;
+    size_t used;
+  };
+
+  ostream *cmp, *st;
+  matWriter *cmpb;
+  spikeWriter *stb;
+  bool async;
+  vector<frame> frames;
+  frame *cur;
+#ifdef ALOUTPUT_ASYNC
+  spscQueue<frame *> *full, *empty;
+  std::thread writer;
+  std::atomic<bool> done;
+#endif
+
+  void writeSpikes(double, const unsigned int *, unsigned int);
+  void writeState(double, const double *, unsigned int);
+  void writeFrame(frame *);
+  void writerLoop();
+  frame *getEmpty();
+  void put(int, double, const void *, unsigned int, size_t);
+
+ public:
+  double blockedTime; //!< time the simulation thread waited for the writer
+  unsigned long blockedN; //!< how often it had to wait
+  unsigned long frameN; //!< frames handed to the writer
+
+  ALoutput(ostream *, matWriter *, ostream *, spikeWriter *, bool, unsigned int, size_t);
+  ~ALoutput();
+  void spikes(double, const vector<unsigned int> &);
+  void spikes(double, const unsigned int *, unsigned int);
+  void state(double, const vector<double> &);
+  void finish();
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#include "ALrates.h"
+#include <cmath>
+
+ALrates::ALrates(): N(0), tau(0.0), dt(1.0), bin(0.0), started(false), row(0), binNo(0)
+{
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Start writing name.sdf (if _tau > 0) with rows every _dt ms and
+  name.rate (if _bin > 0) for the neurons called names at time t0; as text
+  (format 0), binary name.sdfb and name.rateb with values of valueBytes
+  bytes (1) or both (2). The filters are only set up by the first call; a
+  later one (a branch of the run) continues them into new files.
+ */
+//--------------------------------------------------------------------------
+
+void ALrates::open(string name, const vector<string> &names, double _tau, double _dt, double _bin, double t0, int format, unsigned int valueBytes)
+{
+  if (!started) {
+    N= names.size();
+    tau= _tau;
+    dt= _dt;
+    bin= _bin;
+    A.assign(N, 0.0);
+    B.assign(N, 0.0);
+    tl.assign(N, t0);
+    cnt.assign(N, 0);
+    row= (long) ceil(t0/dt);
+    binNo= (bin > 0.0) ? (long) floor(t0/bin) : 0;
+    v.resize(N);
+    started= true;
+  }
+  vector<string> col(1, "t");
+  col.insert(col.end(), names.begin(), names.end());
+  if (tau > 0.0) {
+    if (format != 1) {
+      sdfos.open((name+".sdf").c_str());
+      sdfos.precision(10);
+    }
+    if (format > 0) sdfb.open(name+".sdfb", col, valueBytes, row*dt, dt);
+  }
+  if (bin > 0.0) {
+    if (format != 1) rateos.open((name+".rate").c_str());
+    if (format > 0) rateb.open(name+".rateb", col, valueBytes, binNo*bin, bin);
+  }
+}
+
+// the SDF row at time row*dt, from the filters at row*dt+tau
+void ALrates::writeRow()
+{
+  double T= row*dt, E= T+tau;
+  for (unsigned int i= 0; i < N; i++) {
+    double s= E-tl[i];
+    v[i]= (A[i] == 0.0) ? 0.0 : exp(-s/tau)*(B[i]+s*A[i])/(tau*tau);
+  }
+  if (sdfos.is_open()) {
+    sdfos << T << " ";
+    for (unsigned int i= 0; i < N; i++) sdfos << v[i] << " ";
+    sdfos << "\n";
+  }
+  if (sdfb.is_open()) sdfb.row(T, &v[0]);
+  row++;
+}
+
+void ALrates::writeBin()
+{
+  if (rateos.is_open()) {
+    rateos << binNo*bin << " ";
+    for (unsigned int i= 0; i < N; i++) rateos << cnt[i] << " ";
+    rateos << "\n";
+  }
+  if (rateb.is_open()) {
+    for (unsigned int i= 0; i < N; i++) v[i]= cnt[i];
+    rateb.row(binNo*bin, &v[0]);
+  }
+  for (unsigned int i= 0; i < N; i++) cnt[i]= 0;
+  binNo++;
+}
+
+//! write the SDF rows and the bins that are complete at time t
+void ALrates::flush(double t)
+{
+  if (tau > 0.0) {
+    while (row*dt+tau <= t) writeRow();
+  }
+  if (bin > 0.0) {
+    while ((binNo+1)*bin <= t) writeBin();
+  }
+}
+
+//! the n spikes id of time t
+void ALrates::spikes(double t, const unsigned int *id, unsigned int n)
+{
+  if (!started) return;
+  flush(t);
+  for (unsigned int k= 0; k < n; k++) {
+    unsigned int i= id[k];
+    if (tau > 0.0) {
+      double s= t-tl[i], d= exp(-s/tau);
+      B[i]= d*(B[i]+s*A[i]);
+      A[i]= d*A[i]+1.0;
+      tl[i]= t;
+    }
+    cnt[i]++;
+  }
+}
+
+//! close the files at time t; at the end of the run (end) the rows and the bin up to t are written as well
+void ALrates::close(double t, bool end)
+{
+  if (!started) return;
+  flush(t);
+  if (end) {
+    if (tau > 0.0) {
+      while (row*dt < t) writeRow();
+    }
+    if (bin > 0.0) {
+      while (binNo*bin < t) writeBin();
+    }
+  }
+  if (sdfos.is_open()) sdfos.close();
+  if (rateos.is_open()) rateos.close();
+  sdfb.close();
+  rateb.close();
+}
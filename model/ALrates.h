@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file ALrates.h
+
+\brief Spike density functions and binned spike counts of the PNs, hLNs
+and LHIs, worked out while ALsim runs.
+
+The spike density is the one of tools/st2asdf_mult: the spikes convolved
+with the kernel k(s)= s exp(-s/tau)/tau^2, shifted by tau. It is kept as
+two filters per neuron, A= sum exp(-s/tau) and B= sum s exp(-s/tau) over
+the spikes at distance s, which a spike updates recursively and which
+decay in closed form in between. Row i of <base>.sdf (time i*dt) is B at
+time i*dt+tau, and is written once the simulation gets there. <base>.rate
+has the number of spikes of each neuron in bins of the given width.
+Both are text files of "t value value ..." lines in the order of the
+neuron ids of .out.st and/or binary matrix files (.sdfb, .rateb, see
+include/matbin).
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ALRATES_H
+#define ALRATES_H
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include "matbin.h"
+
+using namespace std;
+
+class ALrates
+{
+ private:
+  unsigned int N;
+  double tau, dt, bin;
+  bool started;
+  vector<double> A, B, tl; //!< SDF filters of each neuron at its last spike tl
+  long row; //!< next row of the SDF
+  vector<unsigned int> cnt; //!< spikes in the current bin
+  long binNo;
+  ofstream sdfos, rateos;
+  matWriter sdfb, rateb;
+  vector<double> v;
+
+  void writeRow();
+  void writeBin();
+
+ public:
+  ALrates();
+  bool active() { return (tau > 0.0) || (bin > 0.0); }
+  void open(string, const vector<string> &, double, double, double, double, int format= 0, unsigned int valueBytes= 8);
+  void spikes(double, const unsigned int *, unsigned int);
+  void flush(double);
+  void close(double, bool);
+};
+
+#endif
@@ -17,20 +17,263 @@
 --------------------------------------------------------------------------*/
 
 #include "AL.h"
+#include <map>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #include "gauss.h"
 #include "randomGen.h"
 #include "randomGen.cc"
 #include "standard_deviation.cc"
+#include "spikeio.cc"
+#include "odorbank.cc"
+#include "conbin.cc"
+#include "matbin.cc"
+#include "ALoutput.cc"
+#include "ALrates.cc"
+#include "ALcheckpoint.cc"
+#ifndef CPU_ONLY
 #include "hr_time.cpp"
+#endif
 randomGen R;
 randomGauss RG;
 
 #include "AL.cc"
+#ifdef CPU_ONLY
+#include "ALensemble.cc"
+#endif
 
 CStopWatch timer;
+ALrates rates; // SDF and spike counts, carried over into the branches
 unsigned int sumORN, sumPN, sumhLN, sumLHI =0;
 
+//! the time of the step at which the .out.cmp line after the one at tlastwrite is due
+double nextStateLine(double tlastwrite)
+{
+  long i= lround(t/DT);
+  while (!(i*DT-tlastwrite > write_interval)) i++;
+  return i*DT;
+}
+
+//! the time of the last .out.cmp line at or before t of a run from t= 0; a continued run keeps its grid
+double lastStateLine()
+{
+  double w= 0.0;
+  while (true) {
+    long i= lround(w/DT);
+    while (!(i*DT-w > write_interval)) i++;
+    if (i*DT > t+DT/2) return w;
+    w= i*DT;
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Run the protocol of al from the current time until it ends or t
+  reaches tEnd (tEnd < 0: no limit), writing <dir>/<base>.out.*
+
+  With first, the spikes at the start time are written too; a run that
+  continues from a state file or from a branch point already has them.
+ */
+//--------------------------------------------------------------------------
+
+void simulate(AL &al, unsigned int which, string dir, string base, double tEnd, bool first)
+{
+  string name= dir+"/"+base;
+  double tlastwrite= first ? 0.0 : lastStateLine();
+
+  ofstream os;
+  if (traceFormat != 1) {
+    cerr << "% out file: " << name << ".out.cmp" << endl;
+    os.open((name+".out.cmp").c_str());
+    os.precision(10);
+  }
+  matWriter cmpb;
+  if ((traceFormat > 0) && write_all) {
+    vector<string> col(1, "t"), fsn;
+    al.full_state_names(fsn);
+    col.insert(col.end(), fsn.begin(), fsn.end());
+    cerr << "% binary out file: " << name << ".out.cmpb" << endl;
+    cmpb.open(name+".out.cmpb", col, traceBytes);
+  }
+
+  ofstream stos;
+  bool st= writeSpikes && (spikeFormat != 1), stb= writeSpikes && (spikeFormat > 0);
+  if (st) {
+    cerr << "% out file st: " << name << ".out.st" << endl;
+    stos.open((name+".out.st").c_str());
+    stos.precision(5);
+  }
+  spikeWriter stbw;
+  if (stb) {
+    cerr << "% binary spike file: " << name << ".out.stb" << endl;
+    stbw.open(name+".out.stb", _NPN+_NhLN+_NLHI, DT, 5000, spikeIndex);
+  }
+  string stateOutName= dir+".stateOut.bin";
+  double tnextState= t+writeStateInterval;
+  ALoutput out((traceFormat != 1) ? &os : NULL, cmpb.is_open() ? &cmpb : NULL, st ? &stos : NULL, stb ? &stbw : NULL, asyncOutput, asyncFrames, (size_t) asyncFrameKB*1024);
+  if ((sdfTau > 0.0) || (rateBin > 0.0)) {
+    if (sdfTau > 0.0) cerr << "% spike density file: " << name << ".sdf" << endl;
+    if (rateBin > 0.0) cerr << "% spike count file: " << name << ".rate" << endl;
+    vector<string> neuron;
+    for (int i= 0; i < _NPN; i++) neuron.push_back("PN"+toString(i));
+    for (int i= 0; i < _NhLN; i++) neuron.push_back("hLN"+toString(i));
+    for (int i= 0; i < _NLHI; i++) neuron.push_back("LHI"+toString(i));
+    rates.open(name, neuron, sdfTau, sdfDt, rateBin, t, traceFormat, traceBytes);
+  }
+  vector<double> fsv;
+  vector<unsigned int> ids;
+  if (write_raw || write_all) {
+      // a continued run only writes the line at its start if an uninterrupted run has one there
+      bool line= first || (fabs(t-tlastwrite) < DT/2);
+      if (write_raw) {
+	      if (line) al.output_state(os);
+      }
+      else {
+	      al.output_matlab_helper_full(name);
+	      if (line) {
+		      al.full_state_values(fsv);
+		      out.state(t, fsv);
+	      }
+      }
+  } 
+
+  if (first) {
+    al.spike_ids(ids);
+    out.spikes(t, ids);
+    rates.spikes(t, ids.data(), ids.size());
+  }
+
+  sumORN= sumPN= sumhLN= sumLHI= 0;
+  timer.startTimer();
+  while (al.continues() && ((tEnd < 0.0) || (t < tEnd-DT/2))) {
+    if (write_raw || write_all) {
+        if (t-tlastwrite > write_interval) {
+            if (write_raw) al.output_state(os);	
+	    else {
+	      al.full_state_values(fsv);
+	      out.state(t, fsv);
+	    }
+	    tlastwrite= t;
+        }
+    }
+    // steps up to the next protocol event, .out.cmp line or state file
+    double tStop= (tEnd < 0.0) ? HUGE_VAL : tEnd-DT/2;
+    if (write_raw || write_all) tStop= min(tStop, nextStateLine(tlastwrite)-DT/2);
+    if (writeState && (writeStateInterval > 0.0)) tStop= min(tStop, tnextState-DT/2);
+    unsigned int n= al.run_until(tStop);
+    sumORN+= al.blockCount[0];
+    sumPN+= al.blockCount[1];
+    sumhLN+= al.blockCount[2];
+    sumLHI+= al.blockCount[3];
+    const unsigned int *id= al.blockSpk.data();
+    for (unsigned int k= 0; k < n; k++) {
+      out.spikes(al.blockT[k], id, al.blockSpkN[k]);
+      rates.spikes(al.blockT[k], id, al.blockSpkN[k]);
+      id+= al.blockSpkN[k];
+    }
+    if (writeState && (writeStateInterval > 0.0) && (t >= tnextState-DT/2)) {
+      al.write_state(stateOutName);
+      tnextState+= writeStateInterval;
+    }
+  }
+
+  if (writeState) al.write_state(stateOutName);
+  rates.close(t, !al.continues() || (tEnd < 0.0));
+  out.finish();
+  timer.stopTimer();
+  if (st) stos.close();
+  if (stb) stbw.close();
+  cmpb.close();
+  cerr << "elapsed time: " << timer.getElapsedTime() << ", " << sumORN << " ORN "<< sumPN << " PN " << sumhLN << " LN " << sumLHI << " LHI spikes." << endl;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Continue the simulation from the current state with each of the
+  protocols listed in branchFile, in forked processes.
+
+  branchFile has a line "<output directory> <protocol file>" per branch.
+  At most branchJobs branches run at the same time (0: one per core). The
+  children share the memory of the network copy-on-write, so odors and
+  connectivity are not copied. Each writes its output and its log
+  (<base>.log) to its own directory. Returns the number of failed branches.
+ */
+//--------------------------------------------------------------------------
+
+int run_branches(AL &al, unsigned int which, string base)
+{
+  ifstream is(branchFile.c_str());
+  if (!is.good()) {
+    cerr << "could not open branch file " << branchFile << " ... exiting" << endl;
+    exit(1);
+  }
+  vector<string> dirs, protos;
+  string line;
+  while (getline(is, line)) {
+    stringstream ls(line);
+    string d, p;
+    if (!(ls >> d) || (d[0] == '#')) continue;
+    if (!(ls >> p)) {
+      cerr << "branch file " << branchFile << ": no protocol for " << d << " ... exiting" << endl;
+      exit(1);
+    }
+    dirs.push_back(d);
+    protos.push_back(p);
+  }
+  unsigned int jobs= (branchJobs > 0) ? branchJobs : sysconf(_SC_NPROCESSORS_ONLN);
+  if (jobs < 1) jobs= 1;
+  cerr << "% branching at t= " << t << " into " << dirs.size() << " protocols, " << jobs << " at a time" << endl;
+
+#ifdef CPU_ONLY
+  stopCPUEngine(); // its threads would not exist in the children
+#endif
+  map<pid_t, unsigned int> running;
+  int failed= 0;
+  for (unsigned int i= 0; i <= dirs.size(); i++) {
+    while (!running.empty() && ((running.size() >= jobs) || (i == dirs.size()))) {
+      int status;
+      pid_t pid= waitpid(-1, &status, 0);
+      if (running.find(pid) == running.end()) continue;
+      unsigned int b= running[pid];
+      running.erase(pid);
+      if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+	cerr << "% branch " << dirs[b] << " (" << protos[b] << ") done" << endl;
+      }
+      else {
+	cerr << "% branch " << dirs[b] << " (" << protos[b] << ") failed, see " << dirs[b] << "/" << base << ".log" << endl;
+	failed++;
+      }
+    }
+    if (i == dirs.size()) break;
+    cerr.flush();
+    pid_t pid= fork();
+    if (pid < 0) {
+      cerr << "fork failed for branch " << dirs[i] << " ... exiting" << endl;
+      exit(1);
+    }
+    if (pid == 0) {
+      mkdir(dirs[i].c_str(), 0755);
+      int fd= open((dirs[i]+"/"+base+".log").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd >= 0) {
+	dup2(fd, 2);
+	close(fd);
+      }
+      ifstream pis(protos[i].c_str());
+      if (!pis.good()) {
+	cerr << "could not open protocol " << protos[i] << " ... exiting" << endl;
+	exit(1);
+      }
+      al.switch_protocol(pis, protos[i]);
+      simulate(al, which, dirs[i], base, -1.0, false);
+      exit(0);
+    }
+    running[pid]= i;
+  }
+  return failed;
+}
+
 int main(int argc, char *argv[])
 {
   if (argc != 4) {
@@ -45,8 +288,16 @@ int main(int argc, char *argv[])
   cerr << endl;
 
   unsigned int which= atoi(argv[3]);
+#ifdef CPU_ONLY
+  if (which != CPU) {
+    cerr << "ALsim was built for the CPU only (CPU_ONLY) ... exiting" << endl;
+    exit(1);
+  }
+#endif
 
-  double tlast= 0.0, tlastwrite= 0.0; 
+#ifdef CPU_ONLY
+  INPUTFILE= string(argv[1])+"/"+argv[2]+".in";
+#endif
 
   stringstream sname;
   char thename[80];
@@ -58,26 +309,13 @@ int main(int argc, char *argv[])
   sname >> thename;
   ifstream pris(thename);
 
-  cerr << "% out file: ";
-  sname.clear();
-  sname << argv[1] << "/" << argv[2];
-  sname << ".out.cmp" << ends;
-  sname >> thename;
-  ofstream os(thename);
-  os.precision(10);
-
-  cerr << "% out file st: ";
-  sname.clear();
-  sname << argv[1] << "/" << argv[2];
-  sname << ".out.st" << ends;
-  sname >> thename;
-	cerr << thename << " is thename" << endl;
-  ofstream stos(thename);
-  stos.precision(5);
-
   AL al(which);
-	double tme;
-  int cntrr= 0;
+#ifndef CPU_ONLY
+  if ((which == GPU) && (branchTime >= 0.0)) {
+    cerr << "branching (branchTime) needs the CPU engine ... exiting" << endl;
+    exit(1);
+  }
+#endif
 
   cerr << "% odorPath: " << odorPath << endl;
   cerr << "% odorExtension: " << odorExtension << endl;
@@ -93,66 +331,36 @@ int main(int argc, char *argv[])
 
   al.connect_hLN_PN(LNPNsynFile);
   al.connect_hLN_hLN();
+  if (connOutFile != "") al.write_conn(connOutFile);
   al.allocate_direct_input();
-  al.read_protocol(pris);
+  al.read_protocol(pris, thename);
   al.randomize_V();
   al.enable();
-  if (write_raw || write_all) {
-      if (write_raw) al.output_state(os);
-      else {
-	      al.output_matlab_helper_full(toString(argv[1])+"/"+toString(argv[2]));
-	      al.output_full_state(os);
-      }
-  } 
-
-  if ((int) readState) {
+  if (readState) {
     sname.clear();
     sname << argv[1];
     sname << ".stateIn.bin" << ends;
     sname >> thename;
-    ifstream sis(thename, ios::binary);
-    assert(sis.good());
+    al.read_state(thename);
   }
 
-  al.output_state_st(stos);
-
-  timer.startTimer();
-  while (al.continues()) {
-    if (write_raw || write_all) {
-        if (t-tlastwrite > write_interval) {
-            if (write_raw) al.output_state(os);	
-	    else al.output_full_state(os);
-	    tlastwrite= t;
-        }
-    }
-    al.run();
-    if (which == GPU) {
-  copySpikeNFromDevice();
-	copySpikesFromDevice();
-    }
-	sumORN+=spikeCount_ORN;
-	sumPN+=spikeCount_PN;
-	sumhLN+=spikeCount_hLN;
-	sumLHI+=spikeCount_LHI;
-
-
-    al.output_state_st(stos);
+  if (ensembleFile != "") {
+#ifdef CPU_ONLY
+    ALensemble ens(al, ensembleFile, argv[2]);
+    ens.run();
+    return 0;
+#else
+    cerr << "the ensemble mode (ensembleFile) needs the CPU_ONLY build ... exiting" << endl;
+    exit(1);
+#endif
   }
 
-  if ((int) writeState) {
-      sname.clear();
-      sname << argv[1];
-      sname << ".stateOut.bin" << ends;
-      sname >> thename;
-      ofstream sis(thename, ios::binary);
-      assert(sis.good());
-  }
-  timer.stopTimer();
-  stos.close();
-  tme= timer.getElapsedTime();
+  int failed= 0;
+  simulate(al, which, argv[1], argv[2], branchTime, !readState);
+  if (branchTime >= 0.0) failed= run_branches(al, which, argv[2]);
+#ifndef CPU_ONLY
   cudaDeviceReset();
-  cerr << "elapsed time: " << tme << ", " << sumORN << " ORN "<< sumPN << " PN " << sumhLN << " LN " << sumLHI << " LHI spikes." << endl;
+#endif
 
-  return 0;
+  return (failed > 0) ? 1 : 0;
 }
-  
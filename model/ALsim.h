@@ -21,14 +21,43 @@ using namespace std;
 
 
 double write_interval= 0.5; // time interval when to write values
-short write_raw= 0; // whether to write voltages
-short write_all= 0; // whether to write all variables (should be used alternatively to (not at the same time as) write_raw)
-short readState= 0;  // whether to read a previous dump of the internal state
-short writeState= 0; // whether to dump the internal state
+int write_raw= 0; // whether to write voltages
+int write_all= 0; // whether to write all variables (should be used alternatively to (not at the same time as) write_raw)
+int readState= 0;  // whether to read a previous dump of the internal state (<dir>.stateIn.bin)
+int writeState= 0; // whether to dump the internal state (<dir>.stateOut.bin) at the end
+double writeStateInterval= 0.0; // with writeState, also dump it every so many ms (0: only at the end)
+double branchTime= -1.0; // if >= 0, continue from this time with each protocol in branchFile
+string branchFile= "branches.txt"; // lines of "<output directory> <protocol file>"
+int branchJobs= 0; // branches that run at the same time (0: one per core)
+string ensembleFile= ""; // if set, simulate the networks listed in it together ("<seed> <output directory> <protocol file>" per line)
+int nThreads= 1; // number of threads of the CPU engine (0: one per core)
+int hhKernel= 1; // HH kernel of the CPU engine (0: scalar, 1: best SIMD, 2: AVX2, 3: AVX-512)
+int hhKinetics= 0; // HH rates of the CPU engine (0: exact, 1: table with linear, 2: with cubic interpolation)
+double hhTableVmin= -120.0; // V grid of the rate tables in mV
+double hhTableVmax= 60.0;
+double hhTableDV= 0.05;
+int ornRNG= 1; // ORN spike draws of the CPU engine (0: MYRAND on seedORN as GeNN, 1: Philox keyed by seed, ORN and step)
+int connRNG= 1; // jitter of the synaptic conductances (0: serial from RG as GeNN, 1: Philox keyed by seed, synapse group and synapse; built in parallel in the CPU build)
+int spikeFormat= 0; // spike output (0: text .out.st, 1: binary .out.stb, 2: both)
+int spikeIndex= 1; // store a per neuron index in the binary spike file
+int writeSpikes= 1; // write the spike trains in spikeFormat (0: only the accumulators below)
+double sdfTau= 0.0; // > 0: write the spike density function with kernel t*exp(-t/sdfTau) (as tools/st2asdf_mult) to <base>.sdf
+double sdfDt= 1.0; // time resolution of <base>.sdf in ms
+double rateBin= 0.0; // > 0: write the spike counts in bins of rateBin ms to <base>.rate
+int traceFormat= 0; // .out.cmp, .sdf and .rate (0: text, 1: binary matrix files .out.cmpb, .sdfb and .rateb, 2: both)
+int traceBytes= 8; // bytes per value in the binary matrix files (8: double, 4: float)
+int asyncOutput= 1; // write output on a background thread
+int asyncFrames= 4; // number of output buffers of the background writer
+int asyncFrameKB= 256; // size of each of them in kB
+int lazyPlasticity= 1; // ORNPN1 plasticity of the CPU engine (0: every step, 1: closed form when needed)
+int hLNhLNExact= 0; // uniform hLN-hLN inhibition of the CPU engine (0: n*g at once, 1: g per spike, bit exact with the graph)
 
 string odorPath= "odors";
 string odorExtension= ".para";
-string LNPNsynFile="model/inhibition.dat";
+string LNPNsynFile="model/inhibition.dat"; // glomerular hLN-PN matrix, text or a connectivity file (tools/dat2con)
+string connFile= ""; // if set, take the synapse groups it holds from this connectivity file instead of building them
+string connOutFile= ""; // if set, write the synapse groups to this connectivity file after building them
+int LNPNrank= 0; // > 0: apply the glomerular hLN-PN matrix as a rank LNPNrank approximation (CPU engine)
 
 double t;
 
@@ -0,0 +1,567 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file ensemble_cpu.cc
+
+\brief Batched CPU engine: K independent copies of the AL network step
+together.
+
+Every variable gets a batch dimension that is outermost: variable x of
+neuron (or synapse) i of the network in slot s is x[s*N+i], so the work of
+one network (receptors, ORNs, spike propagation, plasticity) runs on
+contiguous memory, and the HH kernel still runs over the N*K contiguous
+values of several networks at once. The CSR structure of the
+SparseProjections of runner_cpu.cc is shared; the conductances, which
+depend on the seed, are per network.
+
+A network keeps its slot while it runs. When it finishes (ensembleFinish())
+the network in the last running slot moves into its slot, so the running
+networks always fill slots [0, liveN) and finished ones cost nothing. Each
+step the running slots are split into at most one group per thread of
+cpuPool; a group does the synapses and ORNs of each of its networks and
+then the HH kernel for all of them in one call.
+
+The kernels follow runner_cpu.cc operation for operation, including the
+lazy ORNPN1 plasticity (lazyPlasticity, one R segment per network). A
+network gives the same spikes as a single run with its seed that does not
+read its state on the way (write_all 0), as those reads flush the lazy
+synapses.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ENSEMBLE_CPU_CC
+#define ENSEMBLE_CPU_CC
+
+struct ensembleCPU {
+  unsigned int K;
+  unsigned int liveN; //!< running networks; they are in slots [0, liveN)
+  vector<unsigned int> slot; //!< slot of network k
+  vector<unsigned int> net; //!< network in slot s
+  // neurons, [s*N+i]
+  vector<scalar> VORN, sTORN;
+  vector<int> refractORN;
+  vector<uint64_t> seedORN;
+  vector<scalar> VPN, mPN, hPN, nPN, rPN, sTPN;
+  vector<scalar> VhLN, mhLN, hhLN, nhLN, rhLN, sThLN;
+  vector<scalar> VLHI, mLHI, hLHI, nLHI, rLHI, sTLHI;
+  // receptors per glomerulus, [s*_nGLO+g]
+  vector<scalar> r0, rs0, rb, ad, trate, kpow;
+  vector<char> active;
+  vector<const scalar *> kk;
+  vector<uint64_t> thresh; //!< spike threshold of the ORNs of the glomerulus in this step
+  // synapses, [s*N+i] for post-synaptic i, [s*connN+j] for synapse j
+  vector<scalar> inSynORNPN, inSynORNPN1, inSynhLNPN, inSynORNhLN, inSynPNhLN, inSynhLNhLN, inSynPNLHI;
+  vector<scalar> gORNPN, gORNhLN, gPNhLN, ghLNhLN, gPNLHI; // the glomerular hLN-PN matrix (LNPNsynFile) is shared
+  vector<scalar> pORNPN1, grawORNPN1, gORNPN1, lastupdateORNPN1;
+  // per slot
+  vector<lazyRSegment> seg; //!< R segment of the lazy plasticity
+  double lastT; //!< time of the last step done
+  vector<uint64_t> key; //!< Philox key (the seed)
+  vector<scalar> R; //!< RORNPN1
+  vector<scalar> input; //!< direct input of the LHIs, [s*cpuNLHI+i]
+  // spikes of the last step of slot s at [s*N], their number at [s]
+  vector<unsigned int> spkORN, spkPN, spkhLN, spkLHI;
+  vector<unsigned int> spkNORN, spkNPN, spkNhLN, spkNLHI;
+  // scratch; Isyn and oldV of the group starting at slot s0 at [s0*maxN]
+  unsigned int maxN;
+  vector<scalar> Isyn, oldV, gloIn, rankIn;
+  vector<unsigned int> gloCnt;
+  vector<uint64_t> rnd;
+};
+
+void ensembleAllocate(ensembleCPU &E, unsigned int K)
+{
+  E.K= K;
+  E.liveN= K;
+  E.slot.resize(K);
+  E.net.resize(K);
+  for (unsigned int k= 0; k < K; k++) E.slot[k]= E.net[k]= k;
+  E.VORN.resize(cpuNORN*K); E.sTORN.resize(cpuNORN*K);
+  E.refractORN.resize(cpuNORN*K); E.seedORN.resize(cpuNORN*K);
+  vector<scalar> *PNv[6]= {&E.VPN, &E.mPN, &E.hPN, &E.nPN, &E.rPN, &E.sTPN};
+  vector<scalar> *hLNv[6]= {&E.VhLN, &E.mhLN, &E.hhLN, &E.nhLN, &E.rhLN, &E.sThLN};
+  vector<scalar> *LHIv[6]= {&E.VLHI, &E.mLHI, &E.hLHI, &E.nLHI, &E.rLHI, &E.sTLHI};
+  for (int v= 0; v < 6; v++) {
+    PNv[v]->resize(cpuNPN*K);
+    hLNv[v]->resize(cpuNhLN*K);
+    LHIv[v]->resize(cpuNLHI*K);
+  }
+  vector<scalar> *glo[6]= {&E.r0, &E.rs0, &E.rb, &E.ad, &E.trate, &E.kpow};
+  for (int v= 0; v < 6; v++) glo[v]->resize(_nGLO*K);
+  E.active.resize(_nGLO*K);
+  E.kk.resize(_nGLO*K);
+  E.thresh.resize(_nGLO*K);
+  E.inSynORNPN.assign(cpuNPN*K, 0.0);
+  E.inSynORNPN1.assign(cpuNPN*K, 0.0);
+  E.inSynhLNPN.assign(cpuNPN*K, 0.0);
+  E.inSynORNhLN.assign(cpuNhLN*K, 0.0);
+  E.inSynPNhLN.assign(cpuNhLN*K, 0.0);
+  E.inSynhLNhLN.assign(cpuNhLN*K, 0.0);
+  E.inSynPNLHI.assign(cpuNLHI*K, 0.0);
+  E.gORNPN.resize(CORNPN.connN*K);
+  E.gORNhLN.resize(CORNhLN.connN*K);
+  E.gPNhLN.resize(CPNhLN.connN*K);
+  E.ghLNhLN.resize(ChLNhLN.connN*K);
+  E.gPNLHI.resize(CPNLHI.connN*K);
+  E.pORNPN1.resize(CORNPN1.connN*K);
+  E.grawORNPN1.resize(CORNPN1.connN*K);
+  E.gORNPN1.resize(CORNPN1.connN*K);
+  E.lastupdateORNPN1.resize(CORNPN1.connN*K);
+  E.seg.resize(K);
+  E.key.resize(K);
+  E.R.assign(K, 0.0);
+  E.input.assign(cpuNLHI*K, 0.0);
+  E.spkORN.resize(cpuNORN*K); E.spkNORN.assign(K, 0);
+  E.spkPN.resize(cpuNPN*K); E.spkNPN.assign(K, 0);
+  E.spkhLN.resize(cpuNhLN*K); E.spkNhLN.assign(K, 0);
+  E.spkLHI.resize(cpuNLHI*K); E.spkNLHI.assign(K, 0);
+  E.maxN= max(cpuNPN, max(cpuNhLN, cpuNLHI));
+  E.Isyn.resize(E.maxN*K);
+  E.oldV.resize(E.maxN*K);
+  E.gloIn.resize(_nGLO*K);
+  E.rankIn.resize(_nGLO*K);
+  E.gloCnt.resize(_nGLO*K);
+  E.rnd.resize(cpuNORN*K);
+}
+
+//! to be called when the odor input of network k changes
+void ensembleInputChanged(ensembleCPU &E, unsigned int k)
+{
+  const unsigned int s= E.slot[k];
+  for (int g= 0; g < _nGLO; g++) {
+    const scalar *kk= E.kk[s*_nGLO+g];
+    E.kpow[s*_nGLO+g]= pow(kk[5], kk[4]);
+    E.active[s*_nGLO+g]= (kk[0] != 0.0) || (kk[1] != 0.0) || (kk[2] != 0.0) || (kk[3] != 0.0);
+  }
+}
+
+//! x[s*N+i]= src[i] for i < N
+template <class T, class S>
+inline void ensembleSet(vector<T> &x, const S *src, unsigned int N, unsigned int s)
+{
+  std::copy(src, src+N, x.begin()+s*N);
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Copy the network in the runner variables (as built by the AL
+  connect functions for one seed) into network k, with the odor input kk
+  (nGLO blocks of 12, as theKK) and the Philox key key
+ */
+//--------------------------------------------------------------------------
+
+void ensembleLoad(ensembleCPU &E, unsigned int k, const scalar *kk, uint64_t key)
+{
+  const unsigned int s= E.slot[k];
+  ensembleSet(E.VORN, VORN, cpuNORN, s);
+  ensembleSet(E.sTORN, sTORN, cpuNORN, s);
+  ensembleSet(E.refractORN, refractORN, cpuNORN, s);
+  ensembleSet(E.seedORN, seedORN, cpuNORN, s);
+  for (int g= 0; g < _nGLO; g++) {
+    unsigned int n0= g*_nORN;
+    for (unsigned int n= n0+1; n < n0+_nORN; n++) {
+      if ((r0ORN[n] != r0ORN[n0]) || (rs0ORN[n] != rs0ORN[n0]) || (rbORN[n] != rbORN[n0]) || (adORN[n] != adORN[n0]) || (trateORN[n] != trateORN[n0])) {
+	cerr << "ensemble: the ORNs of a glomerulus must start in the same receptor state ... exiting" << endl;
+	exit(1);
+      }
+    }
+    unsigned int x= s*_nGLO+g;
+    E.r0[x]= r0ORN[n0];
+    E.rs0[x]= rs0ORN[n0];
+    E.rb[x]= rbORN[n0];
+    E.ad[x]= adORN[n0];
+    E.trate[x]= trateORN[n0];
+    E.kk[x]= kk+12*g;
+  }
+  ensembleSet(E.VPN, VPN, cpuNPN, s);
+  ensembleSet(E.mPN, mPN, cpuNPN, s);
+  ensembleSet(E.hPN, hPN, cpuNPN, s);
+  ensembleSet(E.nPN, nPN, cpuNPN, s);
+  ensembleSet(E.rPN, rPN, cpuNPN, s);
+  ensembleSet(E.sTPN, sTPN, cpuNPN, s);
+  ensembleSet(E.VhLN, VhLN, cpuNhLN, s);
+  ensembleSet(E.mhLN, mhLN, cpuNhLN, s);
+  ensembleSet(E.hhLN, hhLN, cpuNhLN, s);
+  ensembleSet(E.nhLN, nhLN, cpuNhLN, s);
+  ensembleSet(E.rhLN, rhLN, cpuNhLN, s);
+  ensembleSet(E.sThLN, sThLN, cpuNhLN, s);
+  ensembleSet(E.VLHI, VLHI, cpuNLHI, s);
+  ensembleSet(E.mLHI, mLHI, cpuNLHI, s);
+  ensembleSet(E.hLHI, hLHI, cpuNLHI, s);
+  ensembleSet(E.nLHI, nLHI, cpuNLHI, s);
+  ensembleSet(E.rLHI, rLHI, cpuNLHI, s);
+  ensembleSet(E.sTLHI, sTLHI, cpuNLHI, s);
+  ensembleSet(E.gORNPN, gORNPN, CORNPN.connN, s);
+  ensembleSet(E.gORNhLN, gORNhLN, CORNhLN.connN, s);
+  ensembleSet(E.gPNhLN, gPNhLN, CPNhLN.connN, s);
+  ensembleSet(E.ghLNhLN, ghLNhLN, ChLNhLN.connN, s);
+  ensembleSet(E.gPNLHI, gPNLHI, CPNLHI.connN, s);
+  ensembleSet(E.pORNPN1, pORNPN1, CORNPN1.connN, s);
+  ensembleSet(E.grawORNPN1, grawORNPN1, CORNPN1.connN, s);
+  ensembleSet(E.gORNPN1, gORNPN1, CORNPN1.connN, s);
+  ensembleSet(E.lastupdateORNPN1, lastupdateORNPN1, CORNPN1.connN, s);
+  E.seg[s].open= false;
+  E.seg[s].Rt= base_RORNPN1;
+  E.key[s]= key;
+  ensembleInputChanged(E, k);
+}
+
+//! the block of N values of slot from into slot to
+template <class T>
+inline void ensembleMoveBlock(vector<T> &x, unsigned int N, unsigned int from, unsigned int to)
+{
+  std::copy(x.begin()+from*N, x.begin()+(from+1)*N, x.begin()+to*N);
+}
+
+//! the whole state of slot from into slot to
+void ensembleMove(ensembleCPU &E, unsigned int from, unsigned int to)
+{
+  ensembleMoveBlock(E.VORN, cpuNORN, from, to);
+  ensembleMoveBlock(E.sTORN, cpuNORN, from, to);
+  ensembleMoveBlock(E.refractORN, cpuNORN, from, to);
+  ensembleMoveBlock(E.seedORN, cpuNORN, from, to);
+  vector<scalar> *PNv[9]= {&E.VPN, &E.mPN, &E.hPN, &E.nPN, &E.rPN, &E.sTPN, &E.inSynORNPN, &E.inSynORNPN1, &E.inSynhLNPN};
+  vector<scalar> *hLNv[9]= {&E.VhLN, &E.mhLN, &E.hhLN, &E.nhLN, &E.rhLN, &E.sThLN, &E.inSynORNhLN, &E.inSynPNhLN, &E.inSynhLNhLN};
+  vector<scalar> *LHIv[8]= {&E.VLHI, &E.mLHI, &E.hLHI, &E.nLHI, &E.rLHI, &E.sTLHI, &E.inSynPNLHI, &E.input};
+  for (int v= 0; v < 9; v++) {
+    ensembleMoveBlock(*PNv[v], cpuNPN, from, to);
+    ensembleMoveBlock(*hLNv[v], cpuNhLN, from, to);
+  }
+  for (int v= 0; v < 8; v++) ensembleMoveBlock(*LHIv[v], cpuNLHI, from, to);
+  vector<scalar> *glo[6]= {&E.r0, &E.rs0, &E.rb, &E.ad, &E.trate, &E.kpow};
+  for (int v= 0; v < 6; v++) ensembleMoveBlock(*glo[v], _nGLO, from, to);
+  ensembleMoveBlock(E.active, _nGLO, from, to);
+  ensembleMoveBlock(E.kk, _nGLO, from, to);
+  ensembleMoveBlock(E.gORNPN, CORNPN.connN, from, to);
+  ensembleMoveBlock(E.gORNhLN, CORNhLN.connN, from, to);
+  ensembleMoveBlock(E.gPNhLN, CPNhLN.connN, from, to);
+  ensembleMoveBlock(E.ghLNhLN, ChLNhLN.connN, from, to);
+  ensembleMoveBlock(E.gPNLHI, CPNLHI.connN, from, to);
+  vector<scalar> *ORNPN1v[4]= {&E.pORNPN1, &E.grawORNPN1, &E.gORNPN1, &E.lastupdateORNPN1};
+  for (int v= 0; v < 4; v++) ensembleMoveBlock(*ORNPN1v[v], CORNPN1.connN, from, to);
+  ensembleMoveBlock(E.seg, 1, from, to);
+  ensembleMoveBlock(E.key, 1, from, to);
+  ensembleMoveBlock(E.R, 1, from, to);
+  ensembleMoveBlock(E.spkORN, cpuNORN, from, to);
+  ensembleMoveBlock(E.spkPN, cpuNPN, from, to);
+  ensembleMoveBlock(E.spkhLN, cpuNhLN, from, to);
+  ensembleMoveBlock(E.spkLHI, cpuNLHI, from, to);
+  vector<unsigned int> *spkN[4]= {&E.spkNORN, &E.spkNPN, &E.spkNhLN, &E.spkNLHI};
+  for (int v= 0; v < 4; v++) ensembleMoveBlock(*spkN[v], 1, from, to);
+}
+
+//! take network k out of the batch; the network in the last running slot takes its slot
+void ensembleFinish(ensembleCPU &E, unsigned int k)
+{
+  unsigned int s= E.slot[k];
+  if (s >= E.liveN) return;
+  unsigned int last= --E.liveN;
+  if (s != last) {
+    ensembleMove(E, last, s);
+    unsigned int kl= E.net[last];
+    E.slot[kl]= s;
+    E.net[s]= kl;
+    E.slot[k]= last;
+    E.net[last]= k;
+  }
+}
+
+//--------------------------------------------------------------------------
+// synapses
+//--------------------------------------------------------------------------
+
+//! SYN1 for the spikes of one network
+inline void ensemblePropagate(const unsigned int *spk, unsigned int spkN, const SparseProjection &C, const scalar *g, scalar *inSyn)
+{
+  for (unsigned int i= 0; i < spkN; i++) {
+    unsigned int ipre= spk[i];
+    for (unsigned int j= C.indInG[ipre]; j < C.indInG[ipre+1]; j++) {
+      inSyn[C.ind[j]]+= g[j];
+    }
+  }
+}
+
+//! flushORNPN1() for synapse j of slot s
+inline void ensembleFlush(ensembleCPU &E, unsigned int s, unsigned int j, double t)
+{
+  const unsigned int x= s*CORNPN1.connN+j;
+  int n= (int) floor((t-E.lastupdateORNPN1[x])/DT+0.5)+1;
+  if (n <= 0) return;
+  const lazyRSegment &S= E.seg[s];
+  const double pbase= ORNPN1c[4];
+  const double gmax= ORNPN1c[0], gmid= ORNPN1c[2], gslope= ORNPN1c[3];
+  double d= E.pORNPN1[x]-pbase;
+  int m= (int) floor((E.lastupdateORNPN1[x]-S.ts)/DT+0.5);
+  double e= (S.Rs-S.Rt)*exp((m-1)*lzc.lq);
+  double bn= exp(n*lzc.lb);
+  double sum= S.Rt*pbase*geomSum(0, n, bn) + S.Rt*d*geomSum(1, n, bn);
+  sum+= e*pbase*geomSum(2, n, bn) + e*d*geomSum(3, n, bn);
+  scalar graw= bn*E.grawORNPN1[x]+DT*sum;
+  E.pORNPN1[x]= pbase+d*exp(n*lzc.la);
+  E.grawORNPN1[x]= graw;
+  E.gORNPN1[x]= gmax*(tanh((graw-gmid)/gslope)+1)/2;
+  E.lastupdateORNPN1[x]= t+DT;
+}
+
+//! rewardChangedCPU() for network k
+void ensembleRewardChanged(ensembleCPU &E, unsigned int k, double Rt)
+{
+  const unsigned int s= E.slot[k];
+  if (lazyPlasticity && E.seg[s].open) {
+    for (unsigned int j= 0; j < CORNPN1.connN; j++) ensembleFlush(E, s, j, E.lastT);
+    E.seg[s].open= false;
+  }
+  E.seg[s].Rt= Rt;
+}
+
+//! asynapse simCodeEvnt for all synapses of slot s
+void ensembleEventORNPN1(ensembleCPU &E, unsigned int s)
+{
+  const double pbase= ORNPN1c[4], p_lambda= ORNPN1c[5];
+  const double gmax= ORNPN1c[0], g_lambda= ORNPN1c[1], gmid= ORNPN1c[2], gslope= ORNPN1c[3];
+  const scalar R= E.R[s];
+  const unsigned int x0= s*CORNPN1.connN;
+  scalar *p= &E.pORNPN1[x0], *graw= &E.grawORNPN1[x0], *g= &E.gORNPN1[x0];
+  for (unsigned int j= 0; j < CORNPN1.connN; j++) {
+    scalar lp= p[j];
+    scalar lgraw= graw[j];
+    lp+= (pbase-lp)*DT/p_lambda;
+    lgraw+= -lgraw*DT/g_lambda;
+    lgraw+= R*lp*DT;
+    g[j]= gmax*(tanh((lgraw-gmid)/gslope)+1)/2;
+    p[j]= lp;
+    graw[j]= lgraw;
+  }
+}
+
+//! the synapses of slot s (after ensembleEventORNPN1())
+void ensembleSynapses(ensembleCPU &E, unsigned int s, double t)
+{
+  const unsigned int *spkORN= &E.spkORN[s*cpuNORN], *spkPN= &E.spkPN[s*cpuNPN], *spkhLN= &E.spkhLN[s*cpuNhLN];
+  const unsigned int nORN= E.spkNORN[s], nPN= E.spkNPN[s], nhLN= E.spkNhLN[s];
+  const double A= ORNPN1c[6];
+  const unsigned int y0= s*CORNPN1.connN;
+  scalar *inSynORNPN1= &E.inSynORNPN1[s*cpuNPN], *pORNPN1= &E.pORNPN1[y0];
+  const scalar *gORNPN1= &E.gORNPN1[y0], *sTPN= &E.sTPN[s*cpuNPN], *sTORN= &E.sTORN[s*cpuNORN];
+  ensemblePropagate(spkORN, nORN, CORNPN, &E.gORNPN[s*CORNPN.connN], &E.inSynORNPN[s*cpuNPN]);
+  for (unsigned int i= 0; i < nORN; i++) {
+    unsigned int ipre= spkORN[i];
+    for (unsigned int j= CORNPN1.indInG[ipre]; j < CORNPN1.indInG[ipre+1]; j++) {
+      unsigned int ipost= CORNPN1.ind[j];
+      if (lazyPlasticity) ensembleFlush(E, s, j, t);
+      inSynORNPN1[ipost]+= gORNPN1[j];
+      scalar t_diff= t - sTPN[ipost];
+      if (t_diff < 20.0) pORNPN1[j]+= A;
+    }
+  }
+  ensemblePropagate(spkORN, nORN, CORNhLN, &E.gORNhLN[s*CORNhLN.connN], &E.inSynORNhLN[s*cpuNhLN]);
+  ensemblePropagate(spkPN, nPN, CPNhLN, &E.gPNhLN[s*CPNhLN.connN], &E.inSynPNhLN[s*cpuNhLN]);
+  if (nhLN > 0) {
+    scalar *gloIn= &E.gloIn[s*_nGLO], *inSyn= &E.inSynhLNPN[s*cpuNPN];
+    gloInhLNPN(spkhLN, nhLN, gloIn, &E.rankIn[s*_nGLO], 0, _nGLO);
+    for (unsigned int j= 0; j < cpuNPN; j++) inSyn[j]+= gloIn[j/_nPN];
+  }
+  if (hLNhLNUniform) {
+    if (nhLN > 0) {
+      // as propagatehLNhLN()
+      unsigned int *gloCnt= &E.gloCnt[s*_nGLO];
+      scalar *inSyn= &E.inSynhLNhLN[s*cpuNhLN];
+      for (int g= 0; g < _nGLO; g++) gloCnt[g]= 0;
+      for (unsigned int i= 0; i < nhLN; i++) gloCnt[spkhLN[i]/_nhLN]++;
+      for (unsigned int j= 0; j < cpuNhLN; j++) {
+	unsigned int n= nhLN-gloCnt[j/_nhLN];
+	if (hLNhLNExact) {
+	  for (unsigned int l= 0; l < n; l++) inSyn[j]+= ghLNhLNUniform;
+	}
+	else inSyn[j]+= n*ghLNhLNUniform;
+      }
+    }
+  }
+  else ensemblePropagate(spkhLN, nhLN, ChLNhLN, &E.ghLNhLN[s*ChLNhLN.connN], &E.inSynhLNhLN[s*cpuNhLN]);
+  ensemblePropagate(spkPN, nPN, CPNLHI, &E.gPNLHI[s*CPNLHI.connN], &E.inSynPNLHI[s*cpuNLHI]);
+  for (unsigned int i= 0; i < nPN; i++) {
+    unsigned int ipost= spkPN[i];
+    for (unsigned int l= CORNPN1.revIndInG[ipost]; l < CORNPN1.revIndInG[ipost+1]; l++) {
+      scalar t_diff= t - sTORN[CORNPN1.revInd[l]];
+      if (t_diff < 30.0) {
+	if (lazyPlasticity) ensembleFlush(E, s, CORNPN1.remap[l], t);
+	pORNPN1[CORNPN1.remap[l]]+= A;
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+// neurons
+//--------------------------------------------------------------------------
+
+//! receptors of slots [s0, s1) in one pass over their glomeruli, and the Philox draws of their ORNs in one batch
+void ensembleReceptors(ensembleCPU &E, unsigned int s0, unsigned int s1, double t)
+{
+  const double rateScale= ORNc[5]*pow(2.0, (double) sizeof(uint64_t)*8-16);
+  for (unsigned int x= s0*_nGLO; x < s1*_nGLO; x++) {
+    stepReceptors(E.kk[x], E.kpow[x], E.active[x], E.r0[x], E.rs0[x], E.rb[x], E.ad[x], E.trate[x]);
+    E.thresh[x]= (uint64_t)(rateScale*E.trate[x]*E.ad[x]*DT);
+  }
+  // as drawORN(); Philox does not care which draws are not used
+  if (ornRNG) philox4x32_batch(&E.key[s0], s1-s0, (uint64_t) floor(t/DT+0.5), cpuNORN, &E.rnd[s0*cpuNORN]);
+}
+
+//! ORNs of slot s; ensembleReceptors() must have run
+void ensembleORN(ensembleCPU &E, unsigned int s, double t)
+{
+  const double tspike= ORNc[0], trefract= ORNc[1], Vrest= ORNc[2], Vspike= ORNc[3];
+  const unsigned int y0= s*cpuNORN;
+  scalar *VORN= &E.VORN[y0], *sTORN= &E.sTORN[y0];
+  int *refractORN= &E.refractORN[y0];
+  uint64_t *seedORN= &E.seedORN[y0];
+  const uint64_t *draw= ornRNG ? &E.rnd[y0] : NULL;
+  unsigned int *spk= &E.spkORN[y0];
+  unsigned int &spkN= E.spkNORN[s];
+  spkN= 0;
+  for (int g= 0; g < _nGLO; g++) {
+    uint64_t thresh= E.thresh[s*_nGLO+g];
+    for (unsigned int n= g*_nORN; n < (unsigned int) (g+1)*_nORN; n++) {
+      scalar lV= VORN[n];
+      int lrefract= refractORN[n];
+      bool oldSpike= (lV > 0.0);
+      if (lV >= Vspike) {
+	if (t - sTORN[n] > tspike) {
+	  lV= Vrest;
+	  lrefract= 1;
+	}
+      }
+      else {
+	if (lrefract) {
+	  if (t - sTORN[n] > trefract) lrefract= 0;
+	}
+	else {
+	  uint64_t rnd;
+	  if (draw != NULL) rnd= draw[n] >> 16;
+	  else {
+	    MYRAND(seedORN[n],rnd);
+	  }
+	  if (rnd < thresh) lV= Vspike;
+	}
+      }
+      if ((lV > 0.0) && !oldSpike) {
+	spk[spkN++]= n;
+	sTORN[n]= t;
+      }
+      VORN[n]= lV;
+      refractORN[n]= lrefract;
+    }
+  }
+}
+
+//! HH kernel on the N neurons of each of slots [s0, s1) in one call, Isyn in the group's scratch; then spikes per slot
+void ensembleALN(ensembleCPU &E, const ALNConst &c, unsigned int N, unsigned int s0, unsigned int s1, double t, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, scalar *sT, unsigned int *spk, unsigned int *spkN)
+{
+  const unsigned int x0= s0*N, xN= (s1-s0)*N;
+  scalar *oldV= &E.oldV[s0*E.maxN];
+  for (unsigned int x= 0; x < xN; x++) oldV[x]= V[x0+x];
+  hhStep(c, xN, V+x0, m+x0, h+x0, n+x0, r+x0, &E.Isyn[s0*E.maxN]);
+  for (unsigned int s= s0; s < s1; s++) {
+    spkN[s]= 0;
+    for (unsigned int i= 0; i < N; i++) {
+      unsigned int x= s*N+i;
+      if ((V[x] > 0.0) && !(oldV[x-x0] > 0.0)) {
+	spk[s*N+spkN[s]++]= i;
+	sT[x]= t;
+      }
+    }
+  }
+}
+
+//! the neurons of slots [s0, s1)
+void ensembleNeurons(ensembleCPU &E, unsigned int s0, unsigned int s1, double t)
+{
+  scalar *Isyn= &E.Isyn[s0*E.maxN];
+  ensembleReceptors(E, s0, s1, t);
+  for (unsigned int s= s0; s < s1; s++) ensembleORN(E, s, t);
+
+  unsigned int x0= s0*cpuNPN, xN= (s1-s0)*cpuNPN;
+  for (unsigned int x= 0; x < xN; x++) {
+    scalar lV= E.VPN[x0+x];
+    Isyn[x]= E.inSynORNPN[x0+x]*(psORNPN.Erev-lV);
+    Isyn[x]+= E.inSynORNPN1[x0+x]*(psORNPN1.Erev-lV);
+    Isyn[x]+= E.inSynhLNPN[x0+x]*(pshLNPN.Erev-lV);
+  }
+  ensembleALN(E, PNc, cpuNPN, s0, s1, t, E.VPN.data(), E.mPN.data(), E.hPN.data(), E.nPN.data(), E.rPN.data(), E.sTPN.data(), E.spkPN.data(), E.spkNPN.data());
+  for (unsigned int x= x0; x < x0+xN; x++) {
+    E.inSynORNPN[x]*= psORNPN.expDecay;
+    E.inSynORNPN1[x]*= psORNPN1.expDecay;
+    E.inSynhLNPN[x]*= pshLNPN.expDecay;
+  }
+
+  x0= s0*cpuNhLN; xN= (s1-s0)*cpuNhLN;
+  for (unsigned int x= 0; x < xN; x++) {
+    scalar lV= E.VhLN[x0+x];
+    Isyn[x]= E.inSynORNhLN[x0+x]*(psORNhLN.Erev-lV);
+    Isyn[x]+= E.inSynPNhLN[x0+x]*(psPNhLN.Erev-lV);
+    Isyn[x]+= E.inSynhLNhLN[x0+x]*(pshLNhLN.Erev-lV);
+  }
+  ensembleALN(E, hLNc, cpuNhLN, s0, s1, t, E.VhLN.data(), E.mhLN.data(), E.hhLN.data(), E.nhLN.data(), E.rhLN.data(), E.sThLN.data(), E.spkhLN.data(), E.spkNhLN.data());
+  for (unsigned int x= x0; x < x0+xN; x++) {
+    E.inSynORNhLN[x]*= psORNhLN.expDecay;
+    E.inSynPNhLN[x]*= psPNhLN.expDecay;
+    E.inSynhLNhLN[x]*= pshLNhLN.expDecay;
+  }
+
+  x0= s0*cpuNLHI; xN= (s1-s0)*cpuNLHI;
+  for (unsigned int x= 0; x < xN; x++) {
+    Isyn[x]= E.input[x0+x];
+    Isyn[x]+= E.inSynPNLHI[x0+x]*(psPNLHI.Erev-E.VLHI[x0+x]);
+  }
+  ensembleALN(E, LHIc, cpuNLHI, s0, s1, t, E.VLHI.data(), E.mLHI.data(), E.hLHI.data(), E.nLHI.data(), E.rLHI.data(), E.sTLHI.data(), E.spkLHI.data(), E.spkNLHI.data());
+  for (unsigned int x= x0; x < x0+xN; x++) {
+    E.inSynPNLHI[x]*= psPNLHI.expDecay;
+  }
+}
+
+//! one step of group g of groupN: the synapses, then the neurons of its slots
+struct ensembleTask {
+  ensembleCPU *E;
+  unsigned int groupN;
+  double t;
+  void operator()(unsigned int g, unsigned int) {
+    unsigned int s0= g*E->liveN/groupN, s1= (g+1)*E->liveN/groupN;
+    for (unsigned int s= s0; s < s1; s++) {
+      if (!lazyPlasticity) ensembleEventORNPN1(*E, s);
+      ensembleSynapses(*E, s, t);
+    }
+    ensembleNeurons(*E, s0, s1, t);
+  }
+};
+
+//! advance all running networks by one time step DT; E.R and E.input must be set for this step
+void ensembleStep(ensembleCPU &E, double t)
+{
+  if (hhStep == NULL) startCPUEngine();
+  if (lazyPlasticity) {
+    for (unsigned int s= 0; s < E.liveN; s++) {
+      lazyRSegment &S= E.seg[s];
+      if (!S.open) {
+	S.ts= t;
+	S.Rs= E.R[s];
+	S.open= true;
+      }
+    }
+  }
+  ensembleTask et= {&E, min(E.liveN, cpuPool->size()), t};
+  cpuPool->parallelFor(et.groupN, et);
+  E.lastT= t;
+}
+
+#endif
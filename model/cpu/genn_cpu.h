@@ -0,0 +1,278 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file genn_cpu.h
+
+\brief Minimal stand-ins for the parts of GeNN (modelSpec, toString,
+hr_time, utils) that ALmodel.cc, AL.cc and ALsim.cu rely on. Used in the
+standalone CPU build (CPU_ONLY) so that neither the CUDA toolkit nor the
+GeNN code generator are needed. The model definitions in ALmodel.cc are
+recorded in an NNmodel exactly as with GeNN; cpu/runner_cpu.cc then binds
+the populations to hand written CPU kernels.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef GENN_CPU_H
+#define GENN_CPU_H
+
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <sys/time.h>
+
+using namespace std;
+
+typedef double scalar;
+
+#define TRUE 1
+#define FALSE 0
+
+#define CPU 0
+#define GPU 1
+
+#define GENN_FLOAT 0
+#define GENN_DOUBLE 1
+
+// connectivity and weight types
+#define ALLTOALL 0
+#define DENSE 1
+#define SPARSE 2
+#define INDIVIDUALG 0
+#define GLOBALG 1
+#define NO_DELAY 0
+
+// direct input rules
+#define CONSTINP 1
+#define MATINP 2
+#define INPRULE 3
+#define RANDNINP 4
+
+// the linear congruential generator used by GeNN's MYRAND
+#define MYRAND(Y,X) Y = Y * 1103515245 + 12345; X = (Y >> 16);
+
+template<typename T>
+std::string toString(T t)
+{
+  std::stringstream s;
+  s << t;
+  return s.str();
+}
+
+#define tS(X) toString(X)
+
+//--------------------------------------------------------------------------
+// model description classes (as in GeNN's modelSpec.h)
+//--------------------------------------------------------------------------
+
+class dpclass
+{
+public:
+  virtual double calculateDerivedParameter(int index, vector<double> pars, double dt) { return -1; }
+  virtual ~dpclass() { }
+};
+
+class neuronModel
+{
+public:
+  string simCode;
+  string thresholdConditionCode;
+  string resetCode;
+  vector<string> varNames;
+  vector<string> varTypes;
+  vector<string> pNames;
+  vector<string> dpNames;
+  vector<string> extraGlobalNeuronKernelParameters;
+  vector<string> extraGlobalNeuronKernelParameterTypes;
+  dpclass *dps;
+
+  neuronModel(): dps(NULL) { }
+};
+
+class weightUpdateModel
+{
+public:
+  string simCode;
+  string simCodeEvnt;
+  string simLearnPost;
+  string evntThreshold;
+  vector<string> varNames;
+  vector<string> varTypes;
+  vector<string> pNames;
+  vector<string> dpNames;
+  vector<string> extraGlobalSynapseKernelParameters;
+  vector<string> extraGlobalSynapseKernelParameterTypes;
+  dpclass *dps;
+  bool needPreSt;
+  bool needPostSt;
+
+  weightUpdateModel(): dps(NULL), needPreSt(FALSE), needPostSt(FALSE) { }
+};
+
+class postSynModel
+{
+public:
+  string postSyntoCurrent;
+  string postSynDecay;
+  vector<string> varNames;
+  vector<string> varTypes;
+  vector<string> pNames;
+  vector<string> dpNames;
+  dpclass *dps;
+
+  postSynModel(): dps(NULL) { }
+};
+
+vector<neuronModel> nModels;
+vector<weightUpdateModel> weightUpdateModels;
+vector<postSynModel> postSynModels;
+
+void initGeNN()
+{
+  nModels.clear();
+  weightUpdateModels.clear();
+  postSynModels.clear();
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Record of the populations of a model; the CPU runner reads sizes,
+  parameters and initial values from here.
+ */
+//--------------------------------------------------------------------------
+
+class NNmodel;
+const NNmodel *theModel= NULL; //!< the finalized model the CPU runner works on
+
+class NNmodel
+{
+public:
+  string name;
+  int ftype;
+  unsigned int seed;
+  // neuron populations
+  vector<string> neuronName;
+  vector<unsigned int> neuronN;
+  vector<unsigned int> neuronType;
+  vector<vector<double> > neuronPara;
+  vector<vector<double> > neuronIni;
+  vector<unsigned int> neuronNeedSt;
+  vector<unsigned int> receivesInputCurrent;
+  // synapse populations
+  vector<string> synapseName;
+  vector<unsigned int> synapseType;
+  vector<unsigned int> synapseConnType;
+  vector<unsigned int> synapseGType;
+  vector<unsigned int> synapsePostSynType;
+  vector<unsigned int> synapseSource;
+  vector<unsigned int> synapseTarget;
+  vector<vector<double> > synapseIni;
+  vector<vector<double> > synapsePara;
+  vector<vector<double> > postSynIni;
+  vector<vector<double> > postSynapsePara;
+
+  NNmodel(): ftype(GENN_DOUBLE), seed(0) { }
+
+  void setName(const string n) { name= n; }
+  void setPrecision(int p) { ftype= p; }
+  void setSeed(unsigned int s) { seed= s; }
+  void setTiming(bool) { }
+  void setGPUDevice(int) { }
+
+  unsigned int findNeuronGrp(const string n) const {
+    for (unsigned int i= 0; i < neuronName.size(); i++) {
+      if (neuronName[i] == n) return i;
+    }
+    cerr << "neuron population " << n << " does not exist ... exiting" << endl;
+    exit(1);
+  }
+
+  unsigned int findSynapseGrp(const string n) const {
+    for (unsigned int i= 0; i < synapseName.size(); i++) {
+      if (synapseName[i] == n) return i;
+    }
+    cerr << "synapse population " << n << " does not exist ... exiting" << endl;
+    exit(1);
+  }
+
+  static vector<double> toVector(const double *p, unsigned int n) {
+    vector<double> v;
+    for (unsigned int i= 0; (p != NULL) && (i < n); i++) v.push_back(p[i]);
+    return v;
+  }
+
+  void addNeuronPopulation(const string n, unsigned int N, unsigned int type, double *p, double *ini) {
+    neuronName.push_back(n);
+    neuronN.push_back(N);
+    neuronType.push_back(type);
+    neuronPara.push_back(toVector(p, nModels[type].pNames.size()));
+    neuronIni.push_back(toVector(ini, nModels[type].varNames.size()));
+    neuronNeedSt.push_back(FALSE);
+    receivesInputCurrent.push_back(0);
+  }
+
+  void activateDirectInput(const string n, unsigned int type) {
+    receivesInputCurrent[findNeuronGrp(n)]= type;
+  }
+
+  void addSynapsePopulation(const string n, unsigned int type, unsigned int conn, unsigned int gtype, unsigned int delay, unsigned int postsyn, const string src, const string trg, double *ini, double *p, double *psini, double *ps) {
+    assert(delay == NO_DELAY);
+    synapseName.push_back(n);
+    synapseType.push_back(type);
+    synapseConnType.push_back(conn);
+    synapseGType.push_back(gtype);
+    synapsePostSynType.push_back(postsyn);
+    synapseSource.push_back(findNeuronGrp(src));
+    synapseTarget.push_back(findNeuronGrp(trg));
+    synapseIni.push_back(toVector(ini, weightUpdateModels[type].varNames.size()));
+    synapsePara.push_back(toVector(p, weightUpdateModels[type].pNames.size()));
+    postSynIni.push_back(toVector(psini, postSynModels[postsyn].varNames.size()));
+    postSynapsePara.push_back(toVector(ps, postSynModels[postsyn].pNames.size()));
+  }
+
+  //! derived parameter "index" of the post-synapse model of synapse population i
+  double postSynDerivedParameter(unsigned int i, int index) const {
+    const postSynModel &ps= postSynModels[synapsePostSynType[i]];
+    assert(ps.dps != NULL);
+    return ps.dps->calculateDerivedParameter(index, postSynapsePara[i], DT);
+  }
+
+  void finalize() {
+    theModel= this;
+  }
+};
+
+//--------------------------------------------------------------------------
+/*! \brief Wall clock timer with the interface of GeNN's hr_time.cpp
+ */
+//--------------------------------------------------------------------------
+
+class CStopWatch
+{
+ private:
+  struct timeval tStart, tStop;
+
+ public:
+  void startTimer() { gettimeofday(&tStart, NULL); }
+  void stopTimer() { gettimeofday(&tStop, NULL); }
+  double getElapsedTime() {
+    return (tStop.tv_sec-tStart.tv_sec)+1e-6*(tStop.tv_usec-tStart.tv_usec);
+  }
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file hhBench.cc
+
+\brief Throughput benchmark of the HONEYALNEURON kernels of the CPU engine.
+
+Steps a population of PNs (parameters as in ALmodel.cc) driven by constant
+currents of different strength with each available kernel, including the
+tabulated kinetics of hhTable.h, and reports neuron updates per second and
+the largest deviation of V from the scalar kernel at the end. Build with "make CPU_ONLY=1 hhBench" and run as
+"cpu/hhBench [neurons] [steps]".
+*/
+//--------------------------------------------------------------------------
+
+#define DT 0.02
+#include "genn_cpu.h"
+#include "hhKernel.h"
+#include "hhTable.h"
+
+struct benchPop {
+  vector<scalar> V, m, h, n, r, Isyn;
+
+  benchPop(unsigned int N): V(N, -70.0), m(N, 0.01899074535), h(N, 0.9899576152), n(N, 0.04034804332), r(N, 0.09), Isyn(N) {
+    for (unsigned int i= 0; i < N; i++) Isyn[i]= 0.5*i/N;
+  }
+};
+
+double runBench(hhKernelFunc f, const ALNConst &c, benchPop &p, unsigned int steps)
+{
+  CStopWatch timer;
+  timer.startTimer();
+  for (unsigned int s= 0; s < steps; s++) {
+    f(c, c.N, p.V.data(), p.m.data(), p.h.data(), p.n.data(), p.r.data(), p.Isyn.data());
+  }
+  timer.stopTimer();
+  return timer.getElapsedTime();
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int N= (argc > 1) ? atoi(argv[1]) : 4096;
+  unsigned int steps= (argc > 2) ? atoi(argv[2]) : 5000;
+  ALNConst c= {N, 7.15, 50.0, 1.43, -95.0, 0.02672, -63.563, 0.143, 0.0, 0.0025, 0.0001, 0.0};
+
+  benchPop ref(N);
+  double tRef= runBench(stepALNScalar, c, ref, steps);
+  cout << "# " << N << " neurons, " << steps << " steps" << endl;
+  cout << "scalar: " << N*(double) steps/tRef << " neurons/s" << endl;
+  for (int mode= 2; mode <= 3; mode++) {
+    string name;
+    hhKernelFunc f= selectHHKernel(mode, name);
+    if ((f == stepALNScalar) || ((mode == 3) && (name != "AVX-512"))) continue;
+    benchPop p(N);
+    double tm= runBench(f, c, p, steps);
+    double dV= 0.0;
+    for (unsigned int i= 0; i < N; i++) dV= max(dV, fabs(p.V[i]-ref.V[i]));
+    cout << name << ": " << N*(double) steps/tm << " neurons/s, speedup " << tRef/tm << ", max |dV| " << dV << " mV" << endl;
+  }
+  for (int mode= 1; mode <= 2; mode++) {
+    buildHHTable(mode, -120.0, 60.0, 0.05);
+    for (int kMode= 0; kMode <= 3; kMode++) {
+      string name;
+      hhKernelFunc f= selectHHTableKernel(kMode, name);
+      if ((kMode == 1) || ((kMode > 0) && (f == stepALNTable)) || ((kMode == 3) && (name.compare(0, 7, "AVX-512") != 0))) continue;
+      benchPop p(N);
+      double tm= runBench(f, c, p, steps);
+      double dV= 0.0;
+      for (unsigned int i= 0; i < N; i++) dV= max(dV, fabs(p.V[i]-ref.V[i]));
+      cout << name << ": " << N*(double) steps/tm << " neurons/s, speedup " << tRef/tm << ", max |dV| " << dV << " mV" << endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file hhKernel.h
+
+\brief The HONEYALNEURON (Hodgkin-Huxley type) kernel of the CPU engine.
+
+The kernel updates a structure-of-arrays block of neurons (V, m, h, n, r)
+given their synaptic currents. There is a scalar version that uses the libm
+exp() exactly like the simCode in ALmodel.cc, and AVX2 and AVX-512 versions
+with a vectorized exp and divide. selectHHKernel() picks one at run time
+according to the hhKernel parameter and what the CPU supports. The AVX2 and
+AVX-512 versions give bit-identical results; they differ from the scalar
+version by rounding only.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef HHKERNEL_H
+#define HHKERNEL_H
+
+#include <immintrin.h>
+
+struct ALNConst {
+  unsigned int N;
+  double gNa, ENa, gK, EK, gl, El, C, gM, kMalpha, kMbeta, I0;
+};
+
+//! the HONEYALNEURON simCode of ALmodel.cc for one neuron
+inline void stepALN(const ALNConst &c, scalar &V, scalar &m, scalar &h, scalar &n, scalar &r, scalar Isyn)
+{
+  scalar Imem= -(m*m*m*h*c.gNa*(V-c.ENa) +
+		 n*n*n*n*c.gK*(V-c.EK) + r*c.gM*(V-c.EK) +
+		 c.gl*(V-c.El) - c.I0 - Isyn);
+  scalar _a= 0.32*(-52.0-V) / (exp((-52.0-V)/4.0)-1.0);
+  scalar _b= 0.28*(25.0+V) / (exp((25.0+V)/5.0)-1.0);
+  m+= (_a*(1.0-m) - _b*m)*DT;
+  _a= 0.128*exp((-48.0-V)/18.0);
+  _b= 4.0 / (exp((-25.0-V)/5.0)+1.0);
+  h+= (_a*(1.0-h) - _b*h)*DT;
+  _a= .032*(-50.0-V) / (exp((-50.0-V)/5.0)-1.0);
+  _b= 0.5*exp((-55.0-V)/40.0);
+  n+= (_a*(1.0-n) - _b*n)*DT;
+  _a= c.kMalpha/(1.0+exp((20.0-V)/5));
+  _b= c.kMbeta;
+  r+= (_a*(1.0-r) - _b*r)*DT;
+  V+= Imem/c.C*DT;
+}
+
+typedef void (*hhKernelFunc)(const ALNConst &, unsigned int, scalar *, scalar *, scalar *, scalar *, scalar *, const scalar *);
+
+//! scalar fallback: update N neurons with the libm exp()
+void stepALNScalar(const ALNConst &c, unsigned int N, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  for (unsigned int i= 0; i < N; i++) {
+    stepALN(c, V[i], m[i], h[i], n[i], r[i], Isyn[i]);
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HH_X86
+
+//--------------------------------------------------------------------------
+// AVX2 + FMA, 4 doubles per vector
+//--------------------------------------------------------------------------
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace hhAVX2 {
+  typedef __m256d vd;
+  const unsigned int LANES= 4;
+  static inline vd vset1(double x) { return _mm256_set1_pd(x); }
+  static inline vd vload(const scalar *p) { return _mm256_loadu_pd(p); }
+  static inline void vstore(scalar *p, vd x) { _mm256_storeu_pd(p, x); }
+  static inline vd vadd(vd a, vd b) { return _mm256_add_pd(a, b); }
+  static inline vd vsub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+  static inline vd vmul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+  static inline vd vdiv(vd a, vd b) { return _mm256_div_pd(a, b); }
+  static inline vd vfma(vd a, vd b, vd c) { return _mm256_fmadd_pd(a, b, c); }
+  static inline vd vmin(vd a, vd b) { return _mm256_min_pd(a, b); }
+  static inline vd vmax(vd a, vd b) { return _mm256_max_pd(a, b); }
+  static inline vd vround(vd a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+  static inline vd vscale2(vd x, vd n) {
+    __m256i e= _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+    e= _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(x, _mm256_castsi256_pd(e));
+  }
+  // table lookup: 32 bit indices, gathers and the lanes outside [lo, hi)
+  typedef __m128i vi;
+  static inline vd vfloor(vd a) { return _mm256_floor_pd(a); }
+  static inline vi vindex(vd k, int stride) { return _mm_mullo_epi32(_mm256_cvttpd_epi32(k), _mm_set1_epi32(stride)); }
+  static inline vd vgather(const double *p, vi idx) { return _mm256_i32gather_pd(p, idx, 8); }
+  static inline int voutside(vd x, double lo, double hi) {
+    vd in= _mm256_and_pd(_mm256_cmp_pd(x, vset1(lo), _CMP_GE_OQ), _mm256_cmp_pd(x, vset1(hi), _CMP_LT_OQ));
+    return ~_mm256_movemask_pd(in) & 0xf;
+  }
+#include "hhKernel_simd.h"
+}
+#pragma GCC pop_options
+
+//--------------------------------------------------------------------------
+// AVX-512F, 8 doubles per vector
+//--------------------------------------------------------------------------
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace hhAVX512 {
+  typedef __m512d vd;
+  const unsigned int LANES= 8;
+  static inline vd vset1(double x) { return _mm512_set1_pd(x); }
+  static inline vd vload(const scalar *p) { return _mm512_loadu_pd(p); }
+  static inline void vstore(scalar *p, vd x) { _mm512_storeu_pd(p, x); }
+  static inline vd vadd(vd a, vd b) { return _mm512_add_pd(a, b); }
+  static inline vd vsub(vd a, vd b) { return _mm512_sub_pd(a, b); }
+  static inline vd vmul(vd a, vd b) { return _mm512_mul_pd(a, b); }
+  static inline vd vdiv(vd a, vd b) { return _mm512_div_pd(a, b); }
+  static inline vd vfma(vd a, vd b, vd c) { return _mm512_fmadd_pd(a, b, c); }
+  static inline vd vmin(vd a, vd b) { return _mm512_min_pd(a, b); }
+  static inline vd vmax(vd a, vd b) { return _mm512_max_pd(a, b); }
+  static inline vd vround(vd a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+  static inline vd vscale2(vd x, vd n) { return _mm512_scalef_pd(x, n); }
+  typedef __m256i vi;
+  static inline vd vfloor(vd a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+  static inline vi vindex(vd k, int stride) { return _mm256_mullo_epi32(_mm512_cvttpd_epi32(k), _mm256_set1_epi32(stride)); }
+  static inline vd vgather(const double *p, vi idx) { return _mm512_i32gather_pd(idx, p, 8); }
+  static inline int voutside(vd x, double lo, double hi) {
+    __mmask8 in= _mm512_cmp_pd_mask(x, vset1(lo), _CMP_GE_OQ) & _mm512_cmp_pd_mask(x, vset1(hi), _CMP_LT_OQ);
+    return ~in & 0xff;
+  }
+#include "hhKernel_simd.h"
+}
+#pragma GCC pop_options
+
+#endif
+
+//--------------------------------------------------------------------------
+/*! \brief Choose the HONEYALNEURON kernel: mode 0 is the scalar kernel,
+  mode 1 the widest vector kernel the CPU supports, 2 forces AVX2 and 3
+  forces AVX-512 (falling back if the CPU does not have it).
+ */
+//--------------------------------------------------------------------------
+
+hhKernelFunc selectHHKernel(int mode, string &name)
+{
+#ifdef HH_X86
+  __builtin_cpu_init();
+  bool hasAVX512= __builtin_cpu_supports("avx512f");
+  bool hasAVX2= __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if (((mode == 1) || (mode == 3)) && hasAVX512) {
+    name= "AVX-512";
+    return hhAVX512::stepALNBlock;
+  }
+  if ((mode >= 1) && hasAVX2) {
+    name= "AVX2";
+    return hhAVX2::stepALNBlock;
+  }
+#endif
+  name= "scalar";
+  return stepALNScalar;
+}
+
+#endif
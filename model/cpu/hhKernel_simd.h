@@ -0,0 +1,119 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file hhKernel_simd.h
+
+\brief Vector body of the HONEYALNEURON kernel. This file is included once
+per instruction set by hhKernel.h, inside a namespace that provides the
+vector type vd, the lane number LANES and the primitives vset1, vload,
+vstore, vadd, vsub, vmul, vdiv, vfma (a*b+c), vround and vscale2 (x*2^n);
+hhTable_simd.h also uses the index type vi, vfloor, vindex, vgather and
+voutside.
+Every lane is computed independently, so results do not depend on where a
+neuron sits in a block.
+*/
+//--------------------------------------------------------------------------
+
+//! exp(x) with the Cephes rational approximation on [-ln2/2, ln2/2]
+static inline vd vexp(vd x)
+{
+  x= vmin(vmax(x, vset1(-708.0)), vset1(709.0));
+  vd fx= vround(vmul(x, vset1(1.4426950408889634074)));
+  x= vfma(fx, vset1(-6.93145751953125E-1), x);
+  x= vfma(fx, vset1(-1.42860682030941723212E-6), x);
+  vd xx= vmul(x, x);
+  vd px= vfma(vfma(vset1(1.26177193074810590878E-4), xx, vset1(3.02994407707441961300E-2)), xx, vset1(9.99999999999999999910E-1));
+  px= vmul(px, x);
+  vd qx= vfma(vfma(vfma(vset1(3.00198505138664455042E-6), xx, vset1(2.52448340349684104192E-3)), xx, vset1(2.27265548208155028766E-1)), xx, vset1(2.00000000000000000009E0));
+  vd e= vdiv(px, vsub(qx, px));
+  e= vfma(vset1(2.0), e, vset1(1.0));
+  return vscale2(e, fx);
+}
+
+//! one Euler step of LANES neurons starting at index i
+static inline void stepBlock(const ALNConst &c, unsigned int i, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  const vd one= vset1(1.0);
+  const vd dt= vset1(DT);
+  vd lV= vload(V+i);
+  vd lm= vload(m+i);
+  vd lh= vload(h+i);
+  vd ln= vload(n+i);
+  vd lr= vload(r+i);
+  vd dEK= vsub(lV, vset1(c.EK));
+  vd m3h= vmul(vmul(vmul(lm, lm), lm), lh);
+  vd n2= vmul(ln, ln);
+  vd I= vmul(vmul(m3h, vset1(c.gNa)), vsub(lV, vset1(c.ENa)));
+  I= vfma(vmul(vmul(n2, n2), vset1(c.gK)), dEK, I);
+  I= vfma(vmul(lr, vset1(c.gM)), dEK, I);
+  I= vfma(vset1(c.gl), vsub(lV, vset1(c.El)), I);
+  I= vsub(vsub(I, vset1(c.I0)), vload(Isyn+i));
+  // m
+  vd u= vsub(vset1(-52.0), lV);
+  vd a= vdiv(vmul(vset1(0.32), u), vsub(vexp(vmul(u, vset1(0.25))), one));
+  u= vadd(vset1(25.0), lV);
+  vd b= vdiv(vmul(vset1(0.28), u), vsub(vexp(vmul(u, vset1(0.2))), one));
+  lm= vfma(vsub(vmul(a, vsub(one, lm)), vmul(b, lm)), dt, lm);
+  // h
+  a= vmul(vset1(0.128), vexp(vmul(vsub(vset1(-48.0), lV), vset1(1.0/18.0))));
+  b= vdiv(vset1(4.0), vadd(vexp(vmul(vsub(vset1(-25.0), lV), vset1(0.2))), one));
+  lh= vfma(vsub(vmul(a, vsub(one, lh)), vmul(b, lh)), dt, lh);
+  // n
+  u= vsub(vset1(-50.0), lV);
+  a= vdiv(vmul(vset1(0.032), u), vsub(vexp(vmul(u, vset1(0.2))), one));
+  b= vmul(vset1(0.5), vexp(vmul(vsub(vset1(-55.0), lV), vset1(1.0/40.0))));
+  ln= vfma(vsub(vmul(a, vsub(one, ln)), vmul(b, ln)), dt, ln);
+  // r
+  a= vdiv(vset1(c.kMalpha), vadd(vexp(vmul(vsub(vset1(20.0), lV), vset1(0.2))), one));
+  lr= vfma(vsub(vmul(a, vsub(one, lr)), vmul(vset1(c.kMbeta), lr)), dt, lr);
+  lV= vsub(lV, vmul(I, vset1(DT/c.C)));
+  vstore(V+i, lV);
+  vstore(m+i, lm);
+  vstore(h+i, lh);
+  vstore(n+i, ln);
+  vstore(r+i, lr);
+}
+
+typedef void (*blockFunc)(const ALNConst &, unsigned int, scalar *, scalar *, scalar *, scalar *, scalar *, const scalar *);
+
+//! update N neurons with F; a partial last block is padded through a local buffer
+template <blockFunc F>
+static void stepBlocks(const ALNConst &c, unsigned int N, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  unsigned int i= 0;
+  for (; i+LANES <= N; i+= LANES) {
+    F(c, i, V, m, h, n, r, Isyn);
+  }
+  if (i < N) {
+    scalar buf[6][LANES];
+    unsigned int k= N-i;
+    for (unsigned int j= 0; j < LANES; j++) {
+      unsigned int src= i+((j < k) ? j : 0);
+      buf[0][j]= V[src]; buf[1][j]= m[src]; buf[2][j]= h[src];
+      buf[3][j]= n[src]; buf[4][j]= r[src]; buf[5][j]= Isyn[src];
+    }
+    F(c, 0, buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
+    for (unsigned int j= 0; j < k; j++) {
+      V[i+j]= buf[0][j]; m[i+j]= buf[1][j]; h[i+j]= buf[2][j];
+      n[i+j]= buf[3][j]; r[i+j]= buf[4][j];
+    }
+  }
+}
+
+//! update N neurons
+static void stepALNBlock(const ALNConst &c, unsigned int N, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  stepBlocks<stepBlock>(c, N, V, m, h, n, r, Isyn);
+}
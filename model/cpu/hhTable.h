@@ -0,0 +1,233 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file hhTable.h
+
+\brief Tabulated kinetics for the HONEYALNEURON kernel.
+
+The rates _a and _b of m, h and n and the voltage dependent factor of the
+M current activation only depend on V. buildHHTable() samples them on a
+regular V grid once; stepALNTable() then replaces the eight exp() calls per
+neuron and step by one table lookup with linear or cubic (Catmull-Rom)
+interpolation. Outside the grid the exact expressions are used. The AVX2 and
+AVX-512 versions (hhTable_simd.h) gather the coefficients of each lane's
+interval; selectHHTableKernel() picks one like selectHHKernel().
+reportHHTableAccuracy() compares spike times of an isolated neuron of each
+population against the exact kernel.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef HHTABLE_H
+#define HHTABLE_H
+
+#define HHTAB_FN 7 //!< am, bm, ah, bh, an, bn, r activation shape
+
+struct hhTable {
+  int order; //!< 1: linear, 3: cubic interpolation
+  double Vmin, Vmax, dV, invdV;
+  unsigned int intervalN;
+  vector<double> coef; //!< per interval HHTAB_FN polynomials of order+1 coefficients
+};
+
+hhTable hhTab;
+
+//! the rate expressions of the HONEYALNEURON simCode
+inline void hhRates(double V, double *y)
+{
+  y[0]= 0.32*(-52.0-V) / (exp((-52.0-V)/4.0)-1.0);
+  y[1]= 0.28*(25.0+V) / (exp((25.0+V)/5.0)-1.0);
+  y[2]= 0.128*exp((-48.0-V)/18.0);
+  y[3]= 4.0 / (exp((-25.0-V)/5.0)+1.0);
+  y[4]= .032*(-50.0-V) / (exp((-50.0-V)/5.0)-1.0);
+  y[5]= 0.5*exp((-55.0-V)/40.0);
+  y[6]= 1.0/(1.0+exp((20.0-V)/5));
+}
+
+//! hhRates() at a grid point; at the removable 0/0 poles of am, bm and an the neighbours are averaged
+void hhRatesSafe(double V, double *y)
+{
+  if ((fabs(V+52.0) < 1e-9) || (fabs(V+25.0) < 1e-9) || (fabs(V+50.0) < 1e-9)) {
+    double yl[HHTAB_FN], yr[HHTAB_FN];
+    hhRates(V-1e-6, yl);
+    hhRates(V+1e-6, yr);
+    for (int f= 0; f < HHTAB_FN; f++) y[f]= 0.5*(yl[f]+yr[f]);
+  }
+  else hhRates(V, y);
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Tabulate the rates on [Vmin, Vmax] with step dV; mode 1 is linear
+  and mode 2 cubic interpolation.
+ */
+//--------------------------------------------------------------------------
+
+void buildHHTable(int mode, double Vmin, double Vmax, double dV)
+{
+  assert((mode == 1) || (mode == 2));
+  assert((Vmax > Vmin) && (dV > 0.0));
+  hhTab.order= (mode == 1) ? 1 : 3;
+  hhTab.intervalN= (unsigned int) ceil((Vmax-Vmin)/dV);
+  hhTab.Vmin= Vmin;
+  hhTab.dV= dV;
+  hhTab.invdV= 1.0/dV;
+  hhTab.Vmax= Vmin+hhTab.intervalN*dV;
+  // samples with one extra point on either side for the cubic tangents
+  unsigned int pointN= hhTab.intervalN+3;
+  vector<double> y(pointN*HHTAB_FN);
+  for (unsigned int k= 0; k < pointN; k++) {
+    hhRatesSafe(Vmin+((int) k-1)*dV, &y[k*HHTAB_FN]);
+  }
+  unsigned int cN= hhTab.order+1;
+  hhTab.coef.resize(hhTab.intervalN*HHTAB_FN*cN);
+  for (unsigned int k= 0; k < hhTab.intervalN; k++) {
+    for (int f= 0; f < HHTAB_FN; f++) {
+      double *c= &hhTab.coef[(k*HHTAB_FN+f)*cN];
+      double y0= y[(k+1)*HHTAB_FN+f], y1= y[(k+2)*HHTAB_FN+f];
+      if (hhTab.order == 1) {
+	c[0]= y0;
+	c[1]= y1-y0;
+      }
+      else {
+	double ym= y[k*HHTAB_FN+f], y2= y[(k+3)*HHTAB_FN+f];
+	double m0= 0.5*(y1-ym), m1= 0.5*(y2-y0);
+	c[0]= y0;
+	c[1]= m0;
+	c[2]= 3.0*(y1-y0)-2.0*m0-m1;
+	c[3]= 2.0*(y0-y1)+m0+m1;
+      }
+    }
+  }
+}
+
+//! interpolated rates at V
+inline void hhTableRates(double V, double *y)
+{
+  if (!(V >= hhTab.Vmin) || !(V < hhTab.Vmax)) {
+    hhRates(V, y);
+    return;
+  }
+  double x= (V-hhTab.Vmin)*hhTab.invdV;
+  unsigned int k= (unsigned int) x;
+  if (k >= hhTab.intervalN) k= hhTab.intervalN-1; // V just below Vmax can round to intervalN
+  x-= k;
+  const double *c= &hhTab.coef[k*HHTAB_FN*(hhTab.order+1)];
+  if (hhTab.order == 1) {
+    for (int f= 0; f < HHTAB_FN; f++, c+= 2) y[f]= c[0]+x*c[1];
+  }
+  else {
+    for (int f= 0; f < HHTAB_FN; f++, c+= 4) y[f]= c[0]+x*(c[1]+x*(c[2]+x*c[3]));
+  }
+}
+
+//! the HONEYALNEURON kernel with tabulated rates
+void stepALNTable(const ALNConst &c, unsigned int N, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  double y[HHTAB_FN];
+  for (unsigned int i= 0; i < N; i++) {
+    scalar lV= V[i], lm= m[i], lh= h[i], ln= n[i], lr= r[i];
+    scalar Imem= -(lm*lm*lm*lh*c.gNa*(lV-c.ENa) +
+		   ln*ln*ln*ln*c.gK*(lV-c.EK) + lr*c.gM*(lV-c.EK) +
+		   c.gl*(lV-c.El) - c.I0 - Isyn[i]);
+    hhTableRates(lV, y);
+    m[i]= lm+(y[0]*(1.0-lm) - y[1]*lm)*DT;
+    h[i]= lh+(y[2]*(1.0-lh) - y[3]*lh)*DT;
+    n[i]= ln+(y[4]*(1.0-ln) - y[5]*ln)*DT;
+    r[i]= lr+(c.kMalpha*y[6]*(1.0-lr) - c.kMbeta*lr)*DT;
+    V[i]= lV+Imem/c.C*DT;
+  }
+}
+
+#ifdef HH_X86
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace hhAVX2 {
+#include "hhTable_simd.h"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace hhAVX512 {
+#include "hhTable_simd.h"
+}
+#pragma GCC pop_options
+#endif
+
+//--------------------------------------------------------------------------
+/*! \brief Choose the kernel with tabulated rates; mode is the hhKernel
+  parameter and picks the instruction set as in selectHHKernel()
+ */
+//--------------------------------------------------------------------------
+
+hhKernelFunc selectHHTableKernel(int mode, string &name)
+{
+  string isa;
+  hhKernelFunc f= selectHHKernel(mode, isa);
+  name= isa+((hhTab.order == 1) ? " tabulated (linear)" : " tabulated (cubic)");
+#ifdef HH_X86
+  if (f == hhAVX512::stepALNBlock) return hhAVX512::stepALNTableBlock;
+  if (f == hhAVX2::stepALNBlock) return hhAVX2::stepALNTableBlock;
+#endif
+  return stepALNTable;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Spike times of one isolated neuron with parameters c under a
+  current step of amplitude I from 50 ms to T-50 ms
+ */
+//--------------------------------------------------------------------------
+
+vector<double> hhStepResponse(hhKernelFunc f, const ALNConst &c, const vector<double> &ini, double I, double T)
+{
+  vector<double> st;
+  scalar V= ini[0], m= ini[1], h= ini[2], n= ini[3], r= ini[4];
+  unsigned int steps= (unsigned int) (T/DT);
+  for (unsigned int s= 0; s < steps; s++) {
+    double t= s*DT;
+    scalar Isyn= ((t >= 50.0) && (t < T-50.0)) ? I : 0.0;
+    bool oldSpike= (V > 0.0);
+    f(c, 1, &V, &m, &h, &n, &r, &Isyn);
+    if ((V > 0.0) && !oldSpike) st.push_back(t);
+  }
+  return st;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Print, for a few current steps, the spike count and the largest
+  deviation of the spike times of the tabulated from the exact kernel
+ */
+//--------------------------------------------------------------------------
+
+void reportHHTableAccuracy(const string pop, const ALNConst &c, const vector<double> &ini)
+{
+  const double T= 500.0;
+  const double I[3]= {0.1, 0.3, 1.0};
+  double maxDev= 0.0;
+  int maxCntDiff= 0;
+  unsigned int spikeN= 0;
+  for (int k= 0; k < 3; k++) {
+    vector<double> ex= hhStepResponse(stepALNScalar, c, ini, I[k], T);
+    vector<double> tb= hhStepResponse(stepALNTable, c, ini, I[k], T);
+    spikeN+= ex.size();
+    maxCntDiff= max(maxCntDiff, abs((int) ex.size()-(int) tb.size()));
+    for (unsigned int i= 0; i < min(ex.size(), tb.size()); i++) {
+      maxDev= max(maxDev, fabs(ex[i]-tb[i]));
+    }
+  }
+  cerr << "% " << pop << " tabulated kinetics: " << spikeN << " reference spikes, max spike time deviation ";
+  cerr << maxDev << " ms, max spike count difference " << maxCntDiff << endl;
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file hhTable_simd.h
+
+\brief Vector body of the HONEYALNEURON kernel with tabulated rates,
+included by hhTable.h into the namespaces of hhKernel.h. The polynomial
+coefficients of each lane's interval are gathered from hhTab; lanes with V
+outside the table get the exact rates, as in the scalar version.
+*/
+//--------------------------------------------------------------------------
+
+//! the HHTAB_FN rates of LANES neurons at V
+static inline void vtableRates(vd lV, vd *y)
+{
+  const hhTable &T= hhTab;
+  const int cN= T.order+1;
+  vd x= vmul(vsub(lV, vset1(T.Vmin)), vset1(T.invdV));
+  // V just below Vmax can round to x == intervalN, and lanes outside the
+  // table must not read outside it either
+  vd k= vmin(vmax(vfloor(x), vset1(0.0)), vset1(T.intervalN-1.0));
+  x= vsub(x, k);
+  vi idx= vindex(k, HHTAB_FN*cN);
+  const double *c= &T.coef[0];
+  if (cN == 2) {
+    for (int f= 0; f < HHTAB_FN; f++, c+= 2) y[f]= vfma(x, vgather(c+1, idx), vgather(c, idx));
+  }
+  else {
+    for (int f= 0; f < HHTAB_FN; f++, c+= 4) {
+      vd p= vfma(x, vgather(c+3, idx), vgather(c+2, idx));
+      p= vfma(x, p, vgather(c+1, idx));
+      y[f]= vfma(x, p, vgather(c, idx));
+    }
+  }
+  int out= voutside(lV, T.Vmin, T.Vmax);
+  if (out) {
+    double v[LANES], yl[HHTAB_FN][LANES], ye[HHTAB_FN];
+    vstore(v, lV);
+    for (int f= 0; f < HHTAB_FN; f++) vstore(yl[f], y[f]);
+    for (unsigned int j= 0; j < LANES; j++) {
+      if (!(out & (1 << j))) continue;
+      hhRates(v[j], ye);
+      for (int f= 0; f < HHTAB_FN; f++) yl[f][j]= ye[f];
+    }
+    for (int f= 0; f < HHTAB_FN; f++) y[f]= vload(yl[f]);
+  }
+}
+
+//! one Euler step of LANES neurons starting at index i, with tabulated rates
+static inline void stepBlockTable(const ALNConst &c, unsigned int i, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  const vd one= vset1(1.0);
+  const vd dt= vset1(DT);
+  vd lV= vload(V+i);
+  vd lm= vload(m+i);
+  vd lh= vload(h+i);
+  vd ln= vload(n+i);
+  vd lr= vload(r+i);
+  vd dEK= vsub(lV, vset1(c.EK));
+  vd m3h= vmul(vmul(vmul(lm, lm), lm), lh);
+  vd n2= vmul(ln, ln);
+  vd I= vmul(vmul(m3h, vset1(c.gNa)), vsub(lV, vset1(c.ENa)));
+  I= vfma(vmul(vmul(n2, n2), vset1(c.gK)), dEK, I);
+  I= vfma(vmul(lr, vset1(c.gM)), dEK, I);
+  I= vfma(vset1(c.gl), vsub(lV, vset1(c.El)), I);
+  I= vsub(vsub(I, vset1(c.I0)), vload(Isyn+i));
+  vd y[HHTAB_FN];
+  vtableRates(lV, y);
+  lm= vfma(vsub(vmul(y[0], vsub(one, lm)), vmul(y[1], lm)), dt, lm);
+  lh= vfma(vsub(vmul(y[2], vsub(one, lh)), vmul(y[3], lh)), dt, lh);
+  ln= vfma(vsub(vmul(y[4], vsub(one, ln)), vmul(y[5], ln)), dt, ln);
+  vd a= vmul(vset1(c.kMalpha), y[6]);
+  lr= vfma(vsub(vmul(a, vsub(one, lr)), vmul(vset1(c.kMbeta), lr)), dt, lr);
+  lV= vsub(lV, vmul(I, vset1(DT/c.C)));
+  vstore(V+i, lV);
+  vstore(m+i, lm);
+  vstore(h+i, lh);
+  vstore(n+i, ln);
+  vstore(r+i, lr);
+}
+
+//! update N neurons with tabulated rates
+static void stepALNTableBlock(const ALNConst &c, unsigned int N, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, const scalar *Isyn)
+{
+  stepBlocks<stepBlockTable>(c, N, V, m, h, n, r, Isyn);
+}
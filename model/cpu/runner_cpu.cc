@@ -0,0 +1,1238 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file runner_cpu.cc
+
+\brief Native CPU engine for the AL model. Provides the same variables and
+functions as the runner.cc that GeNN generates for ALmodel (allocateMem(),
+initialize(), stepTimeCPU(), VPN, CORNPN1, ...), but with hand written
+kernels for the ORN and HONEYALNEURON neuron models, the SYN1 and 3-factor
+(asynapse) weight update models and the exponential post-synapse defined in
+ALmodel.cc. Parameters and initial values are taken from the NNmodel built
+by modelDefinition(), so the .in file works exactly as with GeNN.
+
+Update order within one time step follows the GeNN CPU code: synapses
+(using the spikes of the previous step), post-synaptic learning, neurons.
+Both phases are split into chunks that run on a work-stealing thread pool
+with nThreads threads (see startCPUEngine()).
+*/
+//--------------------------------------------------------------------------
+
+#ifndef RUNNER_CPU_CC
+#define RUNNER_CPU_CC
+
+#include "threadPool.h"
+#include "hhKernel.h"
+#include "hhTable.h"
+#include "philox.h"
+#include "lowrank.h"
+
+struct SparseProjection {
+  unsigned int *indInG;
+  unsigned int *ind;
+  unsigned int *preInd;
+  unsigned int *revIndInG;
+  unsigned int *revInd;
+  unsigned int *remap;
+  unsigned int connN;
+  bool mapped; //!< indInG, ind and the conductances are owned by a mapped connectivity file
+};
+
+//--------------------------------------------------------------------------
+// neuron variables
+//--------------------------------------------------------------------------
+
+unsigned int *glbSpkCntORN, *glbSpkORN;
+scalar *sTORN;
+scalar *VORN, *r0ORN, *rs0ORN, *r1ORN, *rs1ORN, *adORN, *rbORN, *trateORN;
+int *refractORN;
+uint64_t *seedORN;
+scalar **kkORN;
+scalar RORN;
+
+unsigned int *glbSpkCntPN, *glbSpkPN;
+scalar *sTPN;
+scalar *VPN, *mPN, *hPN, *nPN, *rPN;
+
+unsigned int *glbSpkCnthLN, *glbSpkhLN;
+scalar *sThLN;
+scalar *VhLN, *mhLN, *hhLN, *nhLN, *rhLN;
+
+unsigned int *glbSpkCntLHI, *glbSpkLHI;
+scalar *sTLHI;
+scalar *VLHI, *mLHI, *hLHI, *nLHI, *rLHI;
+
+#define spikeCount_ORN glbSpkCntORN[0]
+#define spike_ORN glbSpkORN
+#define spikeCount_PN glbSpkCntPN[0]
+#define spike_PN glbSpkPN
+#define spikeCount_hLN glbSpkCnthLN[0]
+#define spike_hLN glbSpkhLN
+#define spikeCount_LHI glbSpkCntLHI[0]
+#define spike_LHI glbSpkLHI
+
+//--------------------------------------------------------------------------
+// synapse variables
+//--------------------------------------------------------------------------
+
+scalar *inSynORNPN;
+SparseProjection CORNPN;
+scalar *gORNPN;
+
+scalar *inSynORNPN1;
+SparseProjection CORNPN1;
+scalar *pORNPN1, *grawORNPN1, *gORNPN1, *lastupdateORNPN1;
+scalar RORNPN1;
+
+scalar *inSynORNhLN;
+SparseProjection CORNhLN;
+scalar *gORNhLN;
+
+scalar *inSynPNhLN;
+SparseProjection CPNhLN;
+scalar *gPNhLN;
+
+scalar *inSynhLNPN;
+scalar *ghLNPNGlo; //!< hLN-PN conductance per pair of glomeruli, [hLN glomerulus*_nGLO+PN glomerulus]
+unsigned int hLNPNRank= 0; //!< > 0: ghLNPNGlo is applied as hLNPNU hLNPNV of this rank
+vector<scalar> hLNPNU, hLNPNV; //!< _nGLO x hLNPNRank and hLNPNRank x _nGLO
+
+scalar *inSynhLNhLN;
+SparseProjection ChLNhLN;
+scalar *ghLNhLN;
+bool hLNhLNUniform= false; //!< hLN-hLN all to all other glomeruli with conductance ghLNhLNUniform and no graph
+scalar ghLNhLNUniform;
+
+scalar *inSynPNLHI;
+SparseProjection CPNLHI;
+scalar *gPNLHI;
+
+//--------------------------------------------------------------------------
+// constants of the kernels, bound from the model in allocateMem()
+//--------------------------------------------------------------------------
+
+struct PostSynConst {
+  double Erev, expDecay;
+};
+
+unsigned int cpuNORN, cpuNPN, cpuNhLN, cpuNLHI;
+double ORNc[ORN_PNO];
+ALNConst PNc, hLNc, LHIc;
+PostSynConst psORNPN, psORNPN1, psORNhLN, psPNhLN, pshLNPN, pshLNhLN, psPNLHI;
+double ORNPN1c[ASYN_PNO];
+hhKernelFunc hhStep= NULL; //!< HONEYALNEURON kernel chosen by selectHHKernel()
+bool cpuRowsSplit= false; //!< false when a projection changed since splitSynapseRows()
+
+//--------------------------------------------------------------------------
+/*! \brief Check that a population uses the model the kernel was written for
+ */
+//--------------------------------------------------------------------------
+
+void checkNeuronKernel(const NNmodel &model, const string pop, const char *vars[], unsigned int varN)
+{
+  const neuronModel &nm= nModels[model.neuronType[model.findNeuronGrp(pop)]];
+  bool ok= (nm.varNames.size() == varN);
+  for (unsigned int i= 0; ok && (i < varN); i++) {
+    ok= (nm.varNames[i] == vars[i]);
+  }
+  if (!ok) {
+    cerr << "CPU runner: population " << pop << " does not match the kernel for its neuron model ... exiting" << endl;
+    exit(1);
+  }
+}
+
+void bindALNConst(const NNmodel &model, const string pop, ALNConst &c)
+{
+  const char *vars[5]= {"V", "m", "h", "n", "r"};
+  checkNeuronKernel(model, pop, vars, 5);
+  unsigned int i= model.findNeuronGrp(pop);
+  const vector<double> &p= model.neuronPara[i];
+  c.N= model.neuronN[i];
+  c.gNa= p[0]; c.ENa= p[1]; c.gK= p[2]; c.EK= p[3]; c.gl= p[4]; c.El= p[5];
+  c.C= p[6]; c.gM= p[7]; c.kMalpha= p[8]; c.kMbeta= p[9]; c.I0= p[10];
+}
+
+void bindPostSynConst(const NNmodel &model, const string syn, PostSynConst &c)
+{
+  unsigned int i= model.findSynapseGrp(syn);
+  c.Erev= model.postSynapsePara[i][0];
+  c.expDecay= model.postSynDerivedParameter(i, 0);
+}
+
+//! free the arrays of C and its conductances g, unless a connectivity file owns them
+void freeSparse(SparseProjection &C, scalar *&g)
+{
+  if (!C.mapped) {
+    delete[] C.indInG;
+    delete[] C.ind;
+    delete[] g;
+  }
+  delete[] C.revIndInG;
+  delete[] C.revInd;
+  delete[] C.remap;
+  C.preInd= NULL;
+  cpuRowsSplit= false;
+  C.revIndInG= NULL;
+  C.revInd= NULL;
+  C.remap= NULL;
+}
+
+//! (re)allocate C and its conductances g; a connect function may run more than once (ensembles)
+void allocateSparse(SparseProjection &C, scalar *&g, unsigned int preN, unsigned int connN)
+{
+  freeSparse(C, g);
+  C.connN= connN;
+  C.indInG= new unsigned int[preN+1];
+  C.ind= new unsigned int[connN];
+  g= new scalar[connN];
+  C.mapped= false;
+}
+
+//! use the arrays of a mapped connectivity file for C and its conductances g, without copying
+void mapSparse(SparseProjection &C, scalar *&g, unsigned int connN, unsigned int *indInG, unsigned int *ind, scalar *gIn)
+{
+  freeSparse(C, g);
+  C.connN= connN;
+  C.indInG= indInG;
+  C.ind= ind;
+  g= gIn;
+  C.mapped= true;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Allocate the neuron arrays and bind kernel constants to the model
+ */
+//--------------------------------------------------------------------------
+
+void allocateMem()
+{
+  assert(theModel != NULL);
+  const NNmodel &model= *theModel;
+  const char *ORNvars[ORN_IVARNO]= {"V", "r0", "rs0", "r1", "rs1", "ad", "rb", "trate", "refract", "seed", "kk"};
+  checkNeuronKernel(model, "ORN", ORNvars, ORN_IVARNO);
+  unsigned int i= model.findNeuronGrp("ORN");
+  cpuNORN= model.neuronN[i];
+  for (int k= 0; k < ORN_PNO; k++) ORNc[k]= model.neuronPara[i][k];
+  bindALNConst(model, "PN", PNc);
+  bindALNConst(model, "hLN", hLNc);
+  bindALNConst(model, "LHI", LHIc);
+  cpuNPN= PNc.N;
+  cpuNhLN= hLNc.N;
+  cpuNLHI= LHIc.N;
+
+  bindPostSynConst(model, "ORNPN", psORNPN);
+  bindPostSynConst(model, "ORNPN1", psORNPN1);
+  bindPostSynConst(model, "ORNhLN", psORNhLN);
+  bindPostSynConst(model, "PNhLN", psPNhLN);
+  bindPostSynConst(model, "hLNPN", pshLNPN);
+  bindPostSynConst(model, "hLNhLN", pshLNhLN);
+  bindPostSynConst(model, "PNLHI", psPNLHI);
+  i= model.findSynapseGrp("ORNPN1");
+  for (int k= 0; k < ASYN_PNO; k++) ORNPN1c[k]= model.synapsePara[i][k];
+
+  glbSpkCntORN= new unsigned int[1];
+  glbSpkORN= new unsigned int[cpuNORN];
+  sTORN= new scalar[cpuNORN];
+  VORN= new scalar[cpuNORN];
+  r0ORN= new scalar[cpuNORN];
+  rs0ORN= new scalar[cpuNORN];
+  r1ORN= new scalar[cpuNORN];
+  rs1ORN= new scalar[cpuNORN];
+  adORN= new scalar[cpuNORN];
+  rbORN= new scalar[cpuNORN];
+  trateORN= new scalar[cpuNORN];
+  refractORN= new int[cpuNORN];
+  seedORN= new uint64_t[cpuNORN];
+  kkORN= new scalar*[cpuNORN];
+
+  glbSpkCntPN= new unsigned int[1];
+  glbSpkPN= new unsigned int[cpuNPN];
+  sTPN= new scalar[cpuNPN];
+  VPN= new scalar[cpuNPN];
+  mPN= new scalar[cpuNPN];
+  hPN= new scalar[cpuNPN];
+  nPN= new scalar[cpuNPN];
+  rPN= new scalar[cpuNPN];
+
+  glbSpkCnthLN= new unsigned int[1];
+  glbSpkhLN= new unsigned int[cpuNhLN];
+  sThLN= new scalar[cpuNhLN];
+  VhLN= new scalar[cpuNhLN];
+  mhLN= new scalar[cpuNhLN];
+  hhLN= new scalar[cpuNhLN];
+  nhLN= new scalar[cpuNhLN];
+  rhLN= new scalar[cpuNhLN];
+
+  glbSpkCntLHI= new unsigned int[1];
+  glbSpkLHI= new unsigned int[cpuNLHI];
+  sTLHI= new scalar[cpuNLHI];
+  VLHI= new scalar[cpuNLHI];
+  mLHI= new scalar[cpuNLHI];
+  hLHI= new scalar[cpuNLHI];
+  nLHI= new scalar[cpuNLHI];
+  rLHI= new scalar[cpuNLHI];
+
+  inSynORNPN= new scalar[cpuNPN];
+  inSynORNPN1= new scalar[cpuNPN];
+  inSynORNhLN= new scalar[cpuNhLN];
+  inSynPNhLN= new scalar[cpuNhLN];
+  inSynhLNPN= new scalar[cpuNPN];
+  ghLNPNGlo= new scalar[_nGLO*_nGLO];
+  inSynhLNhLN= new scalar[cpuNhLN];
+  inSynPNLHI= new scalar[cpuNLHI];
+}
+
+void allocateORNPN(unsigned int connN)
+{
+  allocateSparse(CORNPN, gORNPN, cpuNORN, connN);
+}
+
+void allocateORNPN1(unsigned int connN)
+{
+  allocateSparse(CORNPN1, gORNPN1, cpuNORN, connN);
+  // post-to-pre arrays for simLearnPost
+  CORNPN1.revIndInG= new unsigned int[cpuNPN+1];
+  CORNPN1.revInd= new unsigned int[connN];
+  CORNPN1.remap= new unsigned int[connN];
+  delete[] pORNPN1;
+  delete[] grawORNPN1;
+  delete[] lastupdateORNPN1;
+  pORNPN1= new scalar[connN];
+  grawORNPN1= new scalar[connN];
+  lastupdateORNPN1= new scalar[connN];
+}
+
+void allocateORNhLN(unsigned int connN)
+{
+  allocateSparse(CORNhLN, gORNhLN, cpuNORN, connN);
+}
+
+void allocatePNhLN(unsigned int connN)
+{
+  allocateSparse(CPNhLN, gPNhLN, cpuNPN, connN);
+}
+
+void allocatehLNhLN(unsigned int connN)
+{
+  allocateSparse(ChLNhLN, ghLNhLN, cpuNhLN, connN);
+  hLNhLNUniform= false;
+}
+
+//! hLN-hLN inhibition with the same conductance g from every hLN to every hLN of other glomeruli, without a graph
+void setUniformhLNhLN(scalar g)
+{
+  allocatehLNhLN(0);
+  for (unsigned int i= 0; i <= cpuNhLN; i++) ChLNhLN.indInG[i]= 0;
+  hLNhLNUniform= true;
+  ghLNhLNUniform= g;
+}
+
+void allocatePNLHI(unsigned int connN)
+{
+  allocateSparse(CPNLHI, gPNLHI, cpuNPN, connN);
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Build the post-to-pre (reverse) index of a sparse projection
+ */
+//--------------------------------------------------------------------------
+
+void createPosttoPreArray(unsigned int preN, unsigned int postN, SparseProjection *C)
+{
+  vector<unsigned int> cnt(postN, 0);
+  for (unsigned int i= 0; i < C->connN; i++) cnt[C->ind[i]]++;
+  C->revIndInG[0]= 0;
+  for (unsigned int j= 0; j < postN; j++) {
+    C->revIndInG[j+1]= C->revIndInG[j]+cnt[j];
+    cnt[j]= C->revIndInG[j];
+  }
+  for (unsigned int i= 0; i < preN; i++) {
+    for (unsigned int k= C->indInG[i]; k < C->indInG[i+1]; k++) {
+      unsigned int j= C->ind[k];
+      C->revInd[cnt[j]]= i;
+      C->remap[cnt[j]++]= k;
+    }
+  }
+}
+
+void initializeAllSparseArrays()
+{
+  // nothing to do: there is no device copy on the CPU
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Lazy ORNPN1 plasticity (lazyPlasticity 1).
+
+  Between spikes the asynapse simCodeEvnt is the linear recursion
+  p_j= pbase+d*a^j, graw_j= b*graw_{j-1}+DT*R_j*p_j with a= 1-DT/p_lambda,
+  b= 1-DT/g_lambda, and R relaxes to Rt= base_RORNPN1+reward as
+  R_j= Rt+(Rs-Rt)*q^j, q= 1-DT/RORNPN1_tau. flushORNPN1() applies k steps of
+  it at once with the sums of geometric series, so a synapse is only touched
+  when its ORN or PN spikes or when the state is read. lastupdateORNPN1
+  holds the time of the first step not yet integrated into the synapse.
+  When the reward changes all synapses are flushed and a new R segment
+  starts with the next step.
+ */
+//--------------------------------------------------------------------------
+
+struct lazyORNPN1Const {
+  double a, b, q;
+  double la, lb, lq; //!< log(a), log(b), log(q)
+  double x[4], dx[4], lr[4]; //!< bases 1, a, q, a*q of the series, x-b and log(x/b)
+};
+
+struct lazyRSegment {
+  bool open;
+  double ts, Rs, Rt; //!< first step of the segment, R in that step, R target
+};
+
+lazyORNPN1Const lzc;
+lazyRSegment lzR;
+double lzLastT; //!< time of the last step done
+
+void initLazyORNPN1()
+{
+  double alpha= DT/ORNPN1c[5], beta= DT/ORNPN1c[1], gamma= DT/RORNPN1_tau;
+  lzc.a= 1.0-alpha;
+  lzc.b= 1.0-beta;
+  lzc.q= 1.0-gamma;
+  lzc.la= log1p(-alpha);
+  lzc.lb= log1p(-beta);
+  lzc.lq= log1p(-gamma);
+  lzc.x[0]= 1.0; lzc.dx[0]= beta;
+  lzc.x[1]= lzc.a; lzc.dx[1]= beta-alpha;
+  lzc.x[2]= lzc.q; lzc.dx[2]= beta-gamma;
+  lzc.x[3]= lzc.a*lzc.q; lzc.dx[3]= beta-alpha-gamma+alpha*gamma;
+  for (int i= 0; i < 4; i++) lzc.lr[i]= log1p(lzc.dx[i]/lzc.b);
+  lzR.open= false;
+  lzR.Rt= base_RORNPN1;
+}
+
+//! sum_{j=1..k} b^(k-j) x^j for series i, given bk= b^k
+inline double geomSum(int i, int k, double bk)
+{
+  if (fabs(lzc.dx[i]) < 1e-15) return k*lzc.x[i]*bk/lzc.b;
+  return lzc.x[i]*bk*expm1(k*lzc.lr[i])/lzc.dx[i];
+}
+
+//! integrate synapse j up to and including the step at time t
+inline void flushORNPN1(unsigned int j, double t)
+{
+  int k= (int) floor((t-lastupdateORNPN1[j])/DT+0.5)+1;
+  if (k <= 0) return;
+  const double pbase= ORNPN1c[4];
+  const double gmax= ORNPN1c[0], gmid= ORNPN1c[2], gslope= ORNPN1c[3];
+  double d= pORNPN1[j]-pbase;
+  // R in the first step to integrate is Rt+e*q
+  int m= (int) floor((lastupdateORNPN1[j]-lzR.ts)/DT+0.5);
+  double e= (lzR.Rs-lzR.Rt)*exp((m-1)*lzc.lq);
+  double bk= exp(k*lzc.lb);
+  double sum= lzR.Rt*pbase*geomSum(0, k, bk) + lzR.Rt*d*geomSum(1, k, bk);
+  sum+= e*pbase*geomSum(2, k, bk) + e*d*geomSum(3, k, bk);
+  scalar graw= bk*grawORNPN1[j]+DT*sum;
+  pORNPN1[j]= pbase+d*exp(k*lzc.la);
+  grawORNPN1[j]= graw;
+  gORNPN1[j]= gmax*(tanh((graw-gmid)/gslope)+1)/2;
+  lastupdateORNPN1[j]= t+DT;
+}
+
+void flushAllORNPN1(double t)
+{
+  for (unsigned int j= 0; j < CORNPN1.connN; j++) flushORNPN1(j, t);
+}
+
+//! to be called when the reward changes, before the next step; Rt is the new target of R
+void rewardChangedCPU(double Rt)
+{
+  if (lazyPlasticity && lzR.open) {
+    flushAllORNPN1(lzLastT);
+    lzR.open= false;
+  }
+  lzR.Rt= Rt;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Set all neuron variables to their initial values
+ */
+//--------------------------------------------------------------------------
+
+void initializeALN(const NNmodel &model, const string pop, unsigned int N, unsigned int *spkCnt, scalar *sT, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r)
+{
+  const vector<double> &ini= model.neuronIni[model.findNeuronGrp(pop)];
+  spkCnt[0]= 0;
+  for (unsigned int i= 0; i < N; i++) {
+    sT[i]= -10.0;
+    V[i]= ini[0];
+    m[i]= ini[1];
+    h[i]= ini[2];
+    n[i]= ini[3];
+    r[i]= ini[4];
+  }
+}
+
+void initialize()
+{
+  const NNmodel &model= *theModel;
+  const vector<double> &ini= model.neuronIni[model.findNeuronGrp("ORN")];
+  glbSpkCntORN[0]= 0;
+  for (unsigned int i= 0; i < cpuNORN; i++) {
+    sTORN[i]= -10.0;
+    VORN[i]= ini[0];
+    r0ORN[i]= ini[1];
+    rs0ORN[i]= ini[2];
+    r1ORN[i]= ini[3];
+    rs1ORN[i]= ini[4];
+    adORN[i]= ini[5];
+    rbORN[i]= ini[6];
+    trateORN[i]= ini[7];
+    refractORN[i]= (int) ini[8];
+    seedORN[i]= (uint64_t) ini[9];
+    kkORN[i]= NULL;
+  }
+  initializeALN(model, "PN", cpuNPN, glbSpkCntPN, sTPN, VPN, mPN, hPN, nPN, rPN);
+  initializeALN(model, "hLN", cpuNhLN, glbSpkCnthLN, sThLN, VhLN, mhLN, hhLN, nhLN, rhLN);
+  initializeALN(model, "LHI", cpuNLHI, glbSpkCntLHI, sTLHI, VLHI, mLHI, hLHI, nLHI, rLHI);
+
+  for (unsigned int i= 0; i < cpuNPN; i++) {
+    inSynORNPN[i]= 0.0;
+    inSynORNPN1[i]= 0.0;
+    inSynhLNPN[i]= 0.0;
+  }
+  for (unsigned int i= 0; i < cpuNhLN; i++) {
+    inSynORNhLN[i]= 0.0;
+    inSynPNhLN[i]= 0.0;
+    inSynhLNhLN[i]= 0.0;
+  }
+  for (unsigned int i= 0; i < cpuNLHI; i++) {
+    inSynPNLHI[i]= 0.0;
+  }
+  double g0= model.synapseIni[model.findSynapseGrp("hLNPN")][0];
+  for (int i= 0; i < _nGLO*_nGLO; i++) {
+    ghLNPNGlo[i]= g0;
+  }
+  RORN= 0.0;
+  RORNPN1= 0.0;
+  initLazyORNPN1();
+}
+
+//--------------------------------------------------------------------------
+// chunks: the unit of work of the CPU engine
+//--------------------------------------------------------------------------
+
+//! target ranges [lo, hi) of one chunk and the spikes its neurons emitted
+struct cpuChunk {
+  unsigned int ORN[2], PN[2], hLN[2], LHI[2];
+  vector<unsigned int> spkORN, spkPN, spkhLN, spkLHI;
+  unsigned int spkNORN, spkNPN, spkNhLN, spkNLHI;
+  vector<scalar> Isyn, oldV; //!< scratch of the HONEYALNEURON kernel
+  vector<uint64_t> rnd; //!< scratch of the ORN spike draws
+  vector<scalar> gloIn; //!< scratch of the hLN-PN input per glomerulus
+  vector<unsigned int> gloCnt; //!< scratch of the hLN spikes per glomerulus
+  vector<scalar> rankIn; //!< scratch of the low rank hLN-PN product
+};
+
+vector<cpuChunk> cpuChunks;
+workStealingPool *cpuPool= NULL;
+
+void addChunk(unsigned int ORN0, unsigned int ORN1, unsigned int PN0, unsigned int PN1, unsigned int hLN0, unsigned int hLN1, unsigned int LHI0, unsigned int LHI1)
+{
+  cpuChunk c;
+  c.ORN[0]= ORN0; c.ORN[1]= ORN1;
+  c.PN[0]= PN0; c.PN[1]= PN1;
+  c.hLN[0]= hLN0; c.hLN[1]= hLN1;
+  c.LHI[0]= LHI0; c.LHI[1]= LHI1;
+  c.spkORN.resize(ORN1-ORN0);
+  c.spkPN.resize(PN1-PN0);
+  c.spkhLN.resize(hLN1-hLN0);
+  c.spkLHI.resize(LHI1-LHI0);
+  c.spkNORN= c.spkNPN= c.spkNhLN= c.spkNLHI= 0;
+  c.gloIn.resize(_nGLO);
+  c.gloCnt.resize(_nGLO);
+  c.rankIn.resize(_nGLO);
+  unsigned int maxN= max(PN1-PN0, max(hLN1-hLN0, LHI1-LHI0));
+  c.Isyn.resize(maxN);
+  c.oldV.resize(maxN);
+  c.rnd.resize(ORN1-ORN0);
+  cpuChunks.push_back(c);
+}
+
+//--------------------------------------------------------------------------
+/*! \brief The synapses of each presynaptic row grouped by the chunk that
+  owns their target, so that a chunk only walks its own part of a row. The
+  synapses of a group keep their order in the row, so the adds to each
+  inSyn happen in the same order as in the plain CSR loop.
+ */
+//--------------------------------------------------------------------------
+
+struct rowSplit {
+  unsigned int chunkN; //!< 0: one chunk, the rows are walked as they are
+  vector<unsigned int> start; //!< row i, chunk k: syn[start[i*chunkN+k]] .. syn[start[i*chunkN+k+1]-1]
+  vector<unsigned int> syn;
+};
+
+rowSplit splitORNPN, splitORNPN1, splitORNhLN, splitPNhLN, splithLNhLN, splitPNLHI;
+
+//! group the rows of C (preN neurons) by owner[post], the chunk of each post-synaptic neuron
+void splitRows(rowSplit &S, const SparseProjection &C, unsigned int preN, const vector<unsigned int> &owner)
+{
+  S.start.clear();
+  S.syn.clear();
+  S.chunkN= (cpuChunks.size() > 1) ? cpuChunks.size() : 0;
+  if (S.chunkN == 0) return;
+  unsigned int chunkN= S.chunkN;
+  S.start.assign(preN*chunkN+1, 0);
+  for (unsigned int i= 0; i < preN; i++) {
+    for (unsigned int j= C.indInG[i]; j < C.indInG[i+1]; j++) S.start[i*chunkN+owner[C.ind[j]]+1]++;
+  }
+  for (unsigned int l= 0; l < preN*chunkN; l++) S.start[l+1]+= S.start[l];
+  S.syn.resize(S.start[preN*chunkN]);
+  vector<unsigned int> pos(S.start.begin(), S.start.end()-1);
+  for (unsigned int i= 0; i < preN; i++) {
+    for (unsigned int j= C.indInG[i]; j < C.indInG[i+1]; j++) S.syn[pos[i*chunkN+owner[C.ind[j]]]++]= j;
+  }
+}
+
+//! the chunk of each of the N neurons of a population; range is one of cpuChunk's ranges
+vector<unsigned int> chunkOwner(unsigned int N, unsigned int (cpuChunk::*range)[2])
+{
+  vector<unsigned int> owner(N, 0);
+  for (unsigned int k= 0; k < cpuChunks.size(); k++) {
+    const unsigned int *r= cpuChunks[k].*range;
+    for (unsigned int j= r[0]; j < r[1]; j++) owner[j]= k;
+  }
+  return owner;
+}
+
+//! (re)build the row splits of all projections for the current chunks
+void splitSynapseRows()
+{
+  vector<unsigned int> PN= chunkOwner(cpuNPN, &cpuChunk::PN);
+  vector<unsigned int> hLN= chunkOwner(cpuNhLN, &cpuChunk::hLN);
+  vector<unsigned int> LHI= chunkOwner(cpuNLHI, &cpuChunk::LHI);
+  splitRows(splitORNPN, CORNPN, cpuNORN, PN);
+  splitRows(splitORNPN1, CORNPN1, cpuNORN, PN);
+  splitRows(splitORNhLN, CORNhLN, cpuNORN, hLN);
+  splitRows(splitPNhLN, CPNhLN, cpuNPN, hLN);
+  splitRows(splithLNhLN, ChLNhLN, cpuNhLN, hLN);
+  splitRows(splitPNLHI, CPNLHI, cpuNPN, LHI);
+  cpuRowsSplit= true;
+}
+
+//! the synapses [l0, l1) of row ipre that belong to chunk k; synapse l is S.syn[l], or l itself for one chunk
+inline void rowPart(const rowSplit &S, const SparseProjection &C, unsigned int ipre, unsigned int k, unsigned int &l0, unsigned int &l1)
+{
+  if (S.chunkN == 0) {
+    l0= C.indInG[ipre];
+    l1= C.indInG[ipre+1];
+  }
+  else {
+    l0= S.start[ipre*S.chunkN+k];
+    l1= S.start[ipre*S.chunkN+k+1];
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Receptor state shared by the ORNs of a glomerulus.
+
+  All ORNs of a glomerulus see the same kk block (theKK in AL.cc) and start
+  from the same values, so r0, rs0, rb and with them trate and the
+  adaptation ad are the same for all of them; only V, refract and the random
+  number stream differ. If this holds when the engine starts (gloShared),
+  the receptor ODEs are integrated once per glomerulus and the per ORN
+  copies are only written back by syncStateCPU().
+ */
+//--------------------------------------------------------------------------
+
+struct ORNGlo {
+  scalar r0, rs0, rb, ad, trate;
+  const scalar *kk;
+  double kpow; //!< pow(kk[5],kk[4]), updated by inputChangedCPU()
+  bool active; //!< false if all rates in kk are zero and r0, rs0, rb cannot change
+};
+
+vector<ORNGlo> cpuGlo;
+bool gloShared= false;
+
+//! to be called whenever the odor input (theKK) changes
+void inputChangedCPU()
+{
+  for (unsigned int g= 0; g < cpuGlo.size(); g++) {
+    ORNGlo &G= cpuGlo[g];
+    G.kpow= pow(G.kk[5], G.kk[4]);
+    G.active= (G.kk[0] != 0.0) || (G.kk[1] != 0.0) || (G.kk[2] != 0.0) || (G.kk[3] != 0.0);
+  }
+}
+
+void initORNGlomeruli()
+{
+  cpuGlo.clear();
+  gloShared= (cpuNORN == (unsigned int) (_nGLO*_nORN));
+  for (int g= 0; gloShared && (g < _nGLO); g++) {
+    unsigned int n0= g*_nORN;
+    for (unsigned int n= n0+1; gloShared && (n < n0+_nORN); n++) {
+      gloShared= (kkORN[n] == kkORN[n0]) && (r0ORN[n] == r0ORN[n0]) && (rs0ORN[n] == rs0ORN[n0]);
+      gloShared= gloShared && (rbORN[n] == rbORN[n0]) && (adORN[n] == adORN[n0]) && (trateORN[n] == trateORN[n0]);
+    }
+    ORNGlo G;
+    G.r0= r0ORN[n0];
+    G.rs0= rs0ORN[n0];
+    G.rb= rbORN[n0];
+    G.ad= adORN[n0];
+    G.trate= trateORN[n0];
+    G.kk= kkORN[n0];
+    cpuGlo.push_back(G);
+  }
+  if (!gloShared) cpuGlo.clear();
+  inputChangedCPU();
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Start the thread pool and split the network into chunks.
+
+  With one thread the whole network is a single chunk. With more threads
+  every glomerulus is a chunk (its ORNs, PNs and hLNs) and the LHIs are one
+  more. Chunks only ever write to their own targets and spikes are merged
+  in chunk order, so the results do not depend on the number of threads.
+ */
+//--------------------------------------------------------------------------
+
+void startCPUEngine()
+{
+  unsigned int threadN= (nThreads > 0) ? nThreads : std::thread::hardware_concurrency();
+  if (threadN < 1) threadN= 1;
+  cpuPool= new workStealingPool(threadN);
+  cpuChunks.clear();
+  cpuRowsSplit= false;
+  if ((threadN == 1) || (cpuNORN != (unsigned int) (_nGLO*_nORN)) || (cpuNPN != (unsigned int) (_nGLO*_nPN)) || (cpuNhLN != (unsigned int) (_nGLO*_nhLN))) {
+    addChunk(0, cpuNORN, 0, cpuNPN, 0, cpuNhLN, 0, cpuNLHI);
+  }
+  else {
+    for (int g= 0; g < _nGLO; g++) {
+      addChunk(g*_nORN, (g+1)*_nORN, g*_nPN, (g+1)*_nPN, g*_nhLN, (g+1)*_nhLN, 0, 0);
+    }
+    addChunk(0, 0, 0, 0, 0, 0, 0, cpuNLHI);
+  }
+  string kernelName;
+  if (hhKinetics > 0) {
+    buildHHTable(hhKinetics, hhTableVmin, hhTableVmax, hhTableDV);
+    hhStep= selectHHTableKernel(hhKernel, kernelName);
+    if ((hhKinetics == 2) && (kernelName.compare(0, 4, "AVX2") == 0)) {
+      cerr << "% cubic tables are slower than the AVX2 exp() kernel; consider hhKinetics 1 or 0" << endl;
+    }
+    const NNmodel &model= *theModel;
+    reportHHTableAccuracy("PN", PNc, model.neuronIni[model.findNeuronGrp("PN")]);
+    reportHHTableAccuracy("hLN", hLNc, model.neuronIni[model.findNeuronGrp("hLN")]);
+    reportHHTableAccuracy("LHI", LHIc, model.neuronIni[model.findNeuronGrp("LHI")]);
+  }
+  else hhStep= selectHHKernel(hhKernel, kernelName);
+  initORNGlomeruli();
+  cerr << "% CPU engine: " << threadN << " thread(s), " << cpuChunks.size() << " chunk(s), " << kernelName << " HH kernel";
+  cerr << (gloShared ? ", receptors per glomerulus" : ", receptors per ORN");
+  cerr << (ornRNG ? ", Philox ORN draws" : ", MYRAND ORN draws") << endl;
+}
+
+//--------------------------------------------------------------------------
+// synapse kernels; each only updates targets in [lo, hi), the part of
+// chunk k (see rowSplit)
+//--------------------------------------------------------------------------
+
+//! SYN1: each presynaptic spike adds g to the post-synaptic inSyn
+inline void propagateSYN1(const unsigned int *spk, unsigned int spkN, const SparseProjection &C, const rowSplit &S, unsigned int k, const scalar *g, scalar *inSyn)
+{
+  const unsigned int *syn= S.syn.data();
+  for (unsigned int i= 0; i < spkN; i++) {
+    unsigned int l0, l1;
+    rowPart(S, C, spk[i], k, l0, l1);
+    if (S.chunkN == 0) {
+      for (unsigned int j= l0; j < l1; j++) inSyn[C.ind[j]]+= g[j];
+    }
+    else {
+      for (unsigned int l= l0; l < l1; l++) {
+	unsigned int j= syn[l];
+	inSyn[C.ind[j]]+= g[j];
+      }
+    }
+  }
+}
+
+//! asynapse simCodeEvnt; the event threshold "1" holds for every ORN in every step
+inline void eventORNPN1(const unsigned int *range)
+{
+  const double pbase= ORNPN1c[4], p_lambda= ORNPN1c[5];
+  const double gmax= ORNPN1c[0], g_lambda= ORNPN1c[1], gmid= ORNPN1c[2], gslope= ORNPN1c[3];
+  const double R= RORNPN1;
+  for (unsigned int l= CORNPN1.revIndInG[range[0]]; l < CORNPN1.revIndInG[range[1]]; l++) {
+    unsigned int j= CORNPN1.remap[l];
+    scalar p= pORNPN1[j];
+    scalar graw= grawORNPN1[j];
+    p+= (pbase-p)*DT/p_lambda;
+    graw+= -graw*DT/g_lambda;
+    graw+= R*p*DT;
+    gORNPN1[j]= gmax*(tanh((graw-gmid)/gslope)+1)/2;
+    pORNPN1[j]= p;
+    grawORNPN1[j]= graw;
+  }
+}
+
+//! asynapse simCode
+inline void spikeORNPN1(double t, unsigned int k)
+{
+  const double A= ORNPN1c[6];
+  const rowSplit &S= splitORNPN1;
+  for (unsigned int i= 0; i < glbSpkCntORN[0]; i++) {
+    unsigned int l0, l1;
+    rowPart(S, CORNPN1, glbSpkORN[i], k, l0, l1);
+    for (unsigned int l= l0; l < l1; l++) {
+      unsigned int j= (S.chunkN == 0) ? l : S.syn[l];
+      unsigned int ipost= CORNPN1.ind[j];
+      if (lazyPlasticity) flushORNPN1(j, t);
+      inSynORNPN1[ipost]+= gORNPN1[j];
+      scalar t_diff= t - sTPN[ipost];
+      if (t_diff < 20.0) pORNPN1[j]+= A;
+    }
+  }
+}
+
+//! asynapse simLearnPost
+inline void learnPostORNPN1(double t, const unsigned int *range)
+{
+  const double A= ORNPN1c[6];
+  for (unsigned int i= 0; i < glbSpkCntPN[0]; i++) {
+    unsigned int ipost= glbSpkPN[i];
+    if ((ipost < range[0]) || (ipost >= range[1])) continue;
+    for (unsigned int l= CORNPN1.revIndInG[ipost]; l < CORNPN1.revIndInG[ipost+1]; l++) {
+      scalar t_diff= t - sTORN[CORNPN1.revInd[l]];
+      if (t_diff < 30.0) {
+	if (lazyPlasticity) flushORNPN1(CORNPN1.remap[l], t);
+	pORNPN1[CORNPN1.remap[l]]+= A;
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! \brief hLN-PN inhibition on the PNs in [range[0], range[1]).
+
+  All hLNs of a glomerulus inhibit all PNs of another one with the same
+  conductance, so the input of a PN glomerulus is the sum of the rows of
+  ghLNPNGlo of the spiking hLNs. It is worked out once per glomerulus
+  (in gloIn) and added to its _nPN PNs. In the low rank mode the rows are
+  those of hLNPNU hLNPNV: the rows of hLNPNU are summed (in rankIn) and
+  multiplied by hLNPNV.
+ */
+//--------------------------------------------------------------------------
+
+//! the input of PN glomeruli [g0, g1) for the hLN spikes spk into gloIn
+inline void gloInhLNPN(const unsigned int *spk, unsigned int spkN, scalar *gloIn, scalar *rankIn, unsigned int g0, unsigned int g1)
+{
+  if (hLNPNRank > 0) {
+    const unsigned int k= hLNPNRank;
+    for (unsigned int r= 0; r < k; r++) rankIn[r]= 0.0;
+    for (unsigned int i= 0; i < spkN; i++) {
+      const scalar *u= &hLNPNU[(spk[i]/_nhLN)*k];
+      for (unsigned int r= 0; r < k; r++) rankIn[r]+= u[r];
+    }
+    for (unsigned int g= g0; g < g1; g++) {
+      scalar x= 0.0;
+      for (unsigned int r= 0; r < k; r++) x+= rankIn[r]*hLNPNV[r*_nGLO+g];
+      gloIn[g]= x;
+    }
+  }
+  else {
+    for (unsigned int g= g0; g < g1; g++) gloIn[g]= 0.0;
+    for (unsigned int i= 0; i < spkN; i++) {
+      const scalar *G= ghLNPNGlo+(spk[i]/_nhLN)*_nGLO;
+      for (unsigned int g= g0; g < g1; g++) gloIn[g]+= G[g];
+    }
+  }
+}
+
+inline void propagatehLNPN(const unsigned int *spk, unsigned int spkN, scalar *gloIn, scalar *rankIn, const unsigned int *range)
+{
+  if ((spkN == 0) || (range[0] >= range[1])) return;
+  unsigned int g0= range[0]/_nPN, g1= (range[1]-1)/_nPN+1;
+  gloInhLNPN(spk, spkN, gloIn, rankIn, g0, g1);
+  for (unsigned int j= range[0]; j < range[1]; j++) inSynhLNPN[j]+= gloIn[j/_nPN];
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Switch the hLN-PN inhibition to the rank k approximation of
+  ghLNPNGlo (k= 0: exact). Reports the approximation error and the time of
+  the glomerular product with one and with all glomeruli spiking, exact
+  and approximated.
+ */
+//--------------------------------------------------------------------------
+
+void setLowRankhLNPN(unsigned int k)
+{
+  hLNPNRank= 0;
+  if (k == 0) return;
+  if (k >= (unsigned int) _nGLO) {
+    cerr << "% hLN-PN: rank " << k << " is not below the " << _nGLO << " glomeruli, using the exact matrix" << endl;
+    return;
+  }
+  CStopWatch w;
+  w.startTimer();
+  vector<double> A(ghLNPNGlo, ghLNPNGlo+_nGLO*_nGLO), U, V;
+  vector<double> s= lowrank(A, _nGLO, _nGLO, k, U, V);
+  w.stopTimer();
+  double err= 0.0, nrm= 0.0, maxErr= 0.0, maxA= 0.0;
+  for (int i= 0; i < _nGLO; i++) {
+    for (int j= 0; j < _nGLO; j++) {
+      double x= 0.0;
+      for (unsigned int r= 0; r < k; r++) x+= U[i*k+r]*V[r*_nGLO+j];
+      double d= x-A[i*_nGLO+j];
+      err+= d*d;
+      nrm+= A[i*_nGLO+j]*A[i*_nGLO+j];
+      maxErr= max(maxErr, fabs(d));
+      maxA= max(maxA, fabs(A[i*_nGLO+j]));
+    }
+  }
+  cerr << "% hLN-PN: rank " << k << " approximation in " << w.getElapsedTime() << " s, singular values " << s[0] << " ... " << s[k-1];
+  cerr << ", relative error " << sqrt(err/nrm) << " (Frobenius), " << maxErr/maxA << " (max)" << endl;
+
+  // time the product as the engine does it, for one and for all glomeruli
+  // spiking; each of the four timings doubles its repetitions until it
+  // takes 12.5 ms, so the report costs ~50 ms at any network size
+  hLNPNU.assign(U.begin(), U.end());
+  hLNPNV.assign(V.begin(), V.end());
+  vector<scalar> gloIn(_nGLO), rankIn(k);
+  vector<unsigned int> spk(_nGLO);
+  for (int i= 0; i < _nGLO; i++) spk[i]= i*_nhLN;
+  for (int all= 0; all < 2; all++) {
+    unsigned int spkN= all ? _nGLO : 1;
+    double tm[2];
+    for (int mode= 0; mode < 2; mode++) {
+      hLNPNRank= mode ? k : 0;
+      for (unsigned int reps= 1; ; reps*= 2) {
+	w.startTimer();
+	for (unsigned int r= 0; r < reps; r++) gloInhLNPN(&spk[all ? 0 : r % _nGLO], spkN, gloIn.data(), rankIn.data(), 0, _nGLO);
+	w.stopTimer();
+	tm[mode]= w.getElapsedTime()/reps;
+	if ((w.getElapsedTime() >= 0.0125) || (reps >= (1u << 30))) break;
+      }
+    }
+    cerr << "% hLN-PN: " << spkN << " spiking glomeruli: " << tm[0]*1e9 << " ns exact, " << tm[1]*1e9 << " ns rank " << k << ", speedup " << tm[0]/tm[1] << endl;
+  }
+  hLNPNRank= k;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Uniform hLN-hLN inhibition on the hLNs in [range[0], range[1]).
+
+  An hLN receives g for each spike of an hLN of another glomerulus, i.e.
+  n= (all spikes - spikes of its own glomerulus) times. By default n*g is
+  added at once, O(N) per step instead of the O(N^2) graph; this can differ
+  from the graph in the last ulp. With hLNhLNExact the adds are done one by
+  one, as the graph did, and the result is the same bit for bit.
+ */
+//--------------------------------------------------------------------------
+
+inline void propagatehLNhLN(const unsigned int *spk, unsigned int spkN, unsigned int *gloCnt, scalar g, scalar *inSyn, const unsigned int *range)
+{
+  if ((spkN == 0) || (range[0] >= range[1])) return;
+  unsigned int g0= range[0]/_nhLN, g1= (range[1]-1)/_nhLN+1;
+  for (unsigned int gl= g0; gl < g1; gl++) gloCnt[gl]= 0;
+  for (unsigned int i= 0; i < spkN; i++) {
+    unsigned int gl= spk[i]/_nhLN;
+    if ((gl >= g0) && (gl < g1)) gloCnt[gl]++;
+  }
+  for (unsigned int j= range[0]; j < range[1]; j++) {
+    unsigned int n= spkN-gloCnt[j/_nhLN];
+    if (hLNhLNExact) {
+      for (unsigned int l= 0; l < n; l++) inSyn[j]+= g;
+    }
+    else inSyn[j]+= n*g;
+  }
+}
+
+//! all synaptic input to the targets of chunk c (number k) and post-synaptic learning
+void calcSynapsesChunk(cpuChunk &c, unsigned int k, double t)
+{
+  propagateSYN1(glbSpkORN, glbSpkCntORN[0], CORNPN, splitORNPN, k, gORNPN, inSynORNPN);
+  if (!lazyPlasticity) eventORNPN1(c.PN);
+  spikeORNPN1(t, k);
+  propagateSYN1(glbSpkORN, glbSpkCntORN[0], CORNhLN, splitORNhLN, k, gORNhLN, inSynORNhLN);
+  propagateSYN1(glbSpkPN, glbSpkCntPN[0], CPNhLN, splitPNhLN, k, gPNhLN, inSynPNhLN);
+  propagatehLNPN(glbSpkhLN, glbSpkCnthLN[0], c.gloIn.data(), c.rankIn.data(), c.PN);
+  if (hLNhLNUniform) propagatehLNhLN(glbSpkhLN, glbSpkCnthLN[0], c.gloCnt.data(), ghLNhLNUniform, inSynhLNhLN, c.hLN);
+  else propagateSYN1(glbSpkhLN, glbSpkCnthLN[0], ChLNhLN, splithLNhLN, k, ghLNhLN, inSynhLNhLN);
+  propagateSYN1(glbSpkPN, glbSpkCntPN[0], CPNLHI, splitPNLHI, k, gPNLHI, inSynPNLHI);
+  learnPostORNPN1(t, c.PN);
+}
+
+//--------------------------------------------------------------------------
+// neuron kernels
+//--------------------------------------------------------------------------
+
+//! spike generation of the ORN model of ALmodel.cc; thresh is (uint64_t)(lmax*2^48*trate*ad*DT), draw the Philox draw or NULL for MYRAND
+inline void spikeORN(unsigned int n, double t, uint64_t thresh, const uint64_t *draw, unsigned int *spk, unsigned int &spkN)
+{
+  const double tspike= ORNc[0], trefract= ORNc[1], Vrest= ORNc[2], Vspike= ORNc[3];
+  scalar lV= VORN[n];
+  int lrefract= refractORN[n];
+  bool oldSpike= (lV > 0.0);
+  if (lV >= Vspike) {
+    if (t - sTORN[n] > tspike) {
+      lV= Vrest;
+      lrefract= 1;
+    }
+  }
+  else {
+    if (lrefract) {
+      if (t - sTORN[n] > trefract) lrefract= 0;
+    }
+    else {
+      uint64_t rnd;
+      if (draw != NULL) rnd= *draw >> 16;
+      else {
+	MYRAND(seedORN[n],rnd);
+      }
+      if (rnd < thresh) {
+	lV= Vspike;
+      }
+    }
+  }
+  if ((lV > 0.0) && !oldSpike) {
+    spk[spkN++]= n;
+    sTORN[n]= t;
+  }
+  VORN[n]= lV;
+  refractORN[n]= lrefract;
+}
+
+//! the receptor and adaptation part of the ORN model of ALmodel.cc (odor 0)
+inline void stepReceptors(const scalar *kk, double kpow, bool active, scalar &r0, scalar &rs0, scalar &rb, scalar &ad, scalar &trate)
+{
+  const double brate= ORNc[4], adrate= ORNc[6], recrate= ORNc[7];
+  if (active) {
+    scalar dr= -kk[0]*r0+kk[2]*rs0-kk[3]*r0+kk[1]*rb*kpow;
+    scalar drs= -kk[2]*rs0+kk[3]*r0;
+    scalar tmp= -kk[1]*rb*kpow+kk[0]*r0;
+    r0+= dr*DT;
+    rs0+= drs*DT;
+    ad+= (recrate-(trate*adrate+recrate)*ad)*DT;
+    rb+= tmp*DT;
+  }
+  else ad+= (recrate-(trate*adrate+recrate)*ad)*DT;
+  trate= brate+rs0;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Random numbers of ORNs [start, end) for the step at time t.
+
+  With ornRNG 1 all draws of a step are made up front as a SIMD batch of
+  Philox4x32-10 keyed by the seed and counted by ORN index and step number,
+  so they do not depend on the order of the updates, the number of threads
+  or the vector width. Returns NULL for ornRNG 0 (MYRAND on seedORN as in
+  GeNN).
+ */
+//--------------------------------------------------------------------------
+
+inline const uint64_t *drawORN(cpuChunk &c, unsigned int start, unsigned int end, double t)
+{
+  if (!ornRNG) return NULL;
+  uint64_t step= (uint64_t) floor(t/DT+0.5);
+  philox4x32_batch((uint64_t) seed, start, step, end-start, c.rnd.data());
+  return c.rnd.data();
+}
+
+//! the ORN model of ALmodel.cc for neurons [start, end), each with its own receptor state
+void calcORN(cpuChunk &c, unsigned int start, unsigned int end, double t, unsigned int *spk, unsigned int &spkN)
+{
+  const double rateScale= ORNc[5]*pow(2.0, (double) sizeof(uint64_t)*8-16);
+  const uint64_t *draw= drawORN(c, start, end, t);
+  for (unsigned int n= start; n < end; n++) {
+    const scalar *kk= kkORN[n];
+    stepReceptors(kk, pow(kk[5],kk[4]), true, r0ORN[n], rs0ORN[n], rbORN[n], adORN[n], trateORN[n]);
+    spikeORN(n, t, (uint64_t)(rateScale*trateORN[n]*adORN[n]*DT), draw ? draw+(n-start) : NULL, spk, spkN);
+  }
+}
+
+//! the ORN model for the glomeruli that own ORNs [start, end), receptors once per glomerulus
+void calcORNGlo(cpuChunk &c, unsigned int start, unsigned int end, double t, unsigned int *spk, unsigned int &spkN)
+{
+  const double rateScale= ORNc[5]*pow(2.0, (double) sizeof(uint64_t)*8-16);
+  const uint64_t *draw= drawORN(c, start, end, t);
+  for (unsigned int g= start/_nORN; g < end/_nORN; g++) {
+    ORNGlo &G= cpuGlo[g];
+    stepReceptors(G.kk, G.kpow, G.active, G.r0, G.rs0, G.rb, G.ad, G.trate);
+    uint64_t thresh= (uint64_t)(rateScale*G.trate*G.ad*DT);
+    for (unsigned int n= g*_nORN; n < (g+1)*_nORN; n++) {
+      spikeORN(n, t, thresh, draw ? draw+(n-start) : NULL, spk, spkN);
+    }
+  }
+}
+
+//! run the HH kernel on neurons [start, end) whose Isyn is in the chunk's scratch; then detect spikes
+void stepALNRange(cpuChunk &c, const ALNConst &k, unsigned int start, unsigned int end, double t, scalar *V, scalar *m, scalar *h, scalar *n, scalar *r, scalar *sT, unsigned int *spk, unsigned int &spkN)
+{
+  scalar *oldV= c.oldV.data();
+  for (unsigned int i= start; i < end; i++) oldV[i-start]= V[i];
+  hhStep(k, end-start, V+start, m+start, h+start, n+start, r+start, c.Isyn.data());
+  for (unsigned int i= start; i < end; i++) {
+    if ((V[i] > 0.0) && !(oldV[i-start] > 0.0)) {
+      spk[spkN++]= i;
+      sT[i]= t;
+    }
+  }
+}
+
+void calcPN(cpuChunk &c, unsigned int start, unsigned int end, double t, unsigned int *spk, unsigned int &spkN)
+{
+  scalar *Isyn= c.Isyn.data();
+  for (unsigned int i= start; i < end; i++) {
+    scalar lV= VPN[i];
+    Isyn[i-start]= inSynORNPN[i]*(psORNPN.Erev-lV);
+    Isyn[i-start]+= inSynORNPN1[i]*(psORNPN1.Erev-lV);
+    Isyn[i-start]+= inSynhLNPN[i]*(pshLNPN.Erev-lV);
+  }
+  stepALNRange(c, PNc, start, end, t, VPN, mPN, hPN, nPN, rPN, sTPN, spk, spkN);
+  for (unsigned int i= start; i < end; i++) {
+    inSynORNPN[i]*= psORNPN.expDecay;
+    inSynORNPN1[i]*= psORNPN1.expDecay;
+    inSynhLNPN[i]*= pshLNPN.expDecay;
+  }
+}
+
+void calchLN(cpuChunk &c, unsigned int start, unsigned int end, double t, unsigned int *spk, unsigned int &spkN)
+{
+  scalar *Isyn= c.Isyn.data();
+  for (unsigned int i= start; i < end; i++) {
+    scalar lV= VhLN[i];
+    Isyn[i-start]= inSynORNhLN[i]*(psORNhLN.Erev-lV);
+    Isyn[i-start]+= inSynPNhLN[i]*(psPNhLN.Erev-lV);
+    Isyn[i-start]+= inSynhLNhLN[i]*(pshLNhLN.Erev-lV);
+  }
+  stepALNRange(c, hLNc, start, end, t, VhLN, mhLN, hhLN, nhLN, rhLN, sThLN, spk, spkN);
+  for (unsigned int i= start; i < end; i++) {
+    inSynORNhLN[i]*= psORNhLN.expDecay;
+    inSynPNhLN[i]*= psPNhLN.expDecay;
+    inSynhLNhLN[i]*= pshLNhLN.expDecay;
+  }
+}
+
+void calcLHI(cpuChunk &c, unsigned int start, unsigned int end, scalar *inputLHI, double t, unsigned int *spk, unsigned int &spkN)
+{
+  scalar *Isyn= c.Isyn.data();
+  for (unsigned int i= start; i < end; i++) {
+    Isyn[i-start]= inputLHI[i];
+    Isyn[i-start]+= inSynPNLHI[i]*(psPNLHI.Erev-VLHI[i]);
+  }
+  stepALNRange(c, LHIc, start, end, t, VLHI, mLHI, hLHI, nLHI, rLHI, sTLHI, spk, spkN);
+  for (unsigned int i= start; i < end; i++) {
+    inSynPNLHI[i]*= psPNLHI.expDecay;
+  }
+}
+
+//! update all neurons of chunk c; spikes go to the chunk's own buffers
+void calcNeuronsChunk(cpuChunk &c, scalar *inputLHI, double t)
+{
+  c.spkNORN= c.spkNPN= c.spkNhLN= c.spkNLHI= 0;
+  if (gloShared) calcORNGlo(c, c.ORN[0], c.ORN[1], t, c.spkORN.data(), c.spkNORN);
+  else calcORN(c, c.ORN[0], c.ORN[1], t, c.spkORN.data(), c.spkNORN);
+  calcPN(c, c.PN[0], c.PN[1], t, c.spkPN.data(), c.spkNPN);
+  calchLN(c, c.hLN[0], c.hLN[1], t, c.spkhLN.data(), c.spkNhLN);
+  calcLHI(c, c.LHI[0], c.LHI[1], inputLHI, t, c.spkLHI.data(), c.spkNLHI);
+}
+
+//! concatenate the chunks' spikes in chunk order into the global spike arrays
+void mergeSpikes()
+{
+  glbSpkCntORN[0]= glbSpkCntPN[0]= glbSpkCnthLN[0]= glbSpkCntLHI[0]= 0;
+  for (unsigned int k= 0; k < cpuChunks.size(); k++) {
+    const cpuChunk &c= cpuChunks[k];
+    for (unsigned int i= 0; i < c.spkNORN; i++) glbSpkORN[glbSpkCntORN[0]++]= c.spkORN[i];
+    for (unsigned int i= 0; i < c.spkNPN; i++) glbSpkPN[glbSpkCntPN[0]++]= c.spkPN[i];
+    for (unsigned int i= 0; i < c.spkNhLN; i++) glbSpkhLN[glbSpkCnthLN[0]++]= c.spkhLN[i];
+    for (unsigned int i= 0; i < c.spkNLHI; i++) glbSpkLHI[glbSpkCntLHI[0]++]= c.spkLHI[i];
+  }
+}
+
+struct synapseTask {
+  double t;
+  void operator()(unsigned int k, unsigned int) { calcSynapsesChunk(cpuChunks[k], k, t); }
+};
+
+struct neuronTask {
+  scalar *inputLHI;
+  double t;
+  void operator()(unsigned int k, unsigned int) { calcNeuronsChunk(cpuChunks[k], inputLHI, t); }
+};
+
+//--------------------------------------------------------------------------
+/*! \brief Advance the model by one time step DT
+
+  Synapses of all chunks (reading the spikes of the previous step) run
+  before any neuron is updated, as in the serial GeNN code.
+ */
+//--------------------------------------------------------------------------
+
+void stepTimeCPU(scalar *inputLHI, double t)
+{
+  if (cpuPool == NULL) startCPUEngine();
+  if (!cpuRowsSplit) splitSynapseRows();
+  if (lazyPlasticity && !lzR.open) {
+    lzR.ts= t;
+    lzR.Rs= RORNPN1;
+    lzR.open= true;
+  }
+  synapseTask st= {t};
+  cpuPool->parallelFor(cpuChunks.size(), st);
+  neuronTask nt= {inputLHI, t};
+  cpuPool->parallelFor(cpuChunks.size(), nt);
+  mergeSpikes();
+  lzLastT= t;
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Bring all lazily updated and shared state up to date in the
+  GeNN variables before they are read
+ */
+//--------------------------------------------------------------------------
+
+void syncStateCPU()
+{
+  if (lazyPlasticity && lzR.open) flushAllORNPN1(lzLastT);
+  if (gloShared) {
+    for (unsigned int g= 0; g < cpuGlo.size(); g++) {
+      const ORNGlo &G= cpuGlo[g];
+      for (int n= g*_nORN; n < (int) (g+1)*_nORN; n++) {
+	r0ORN[n]= G.r0;
+	rs0ORN[n]= G.rs0;
+	rbORN[n]= G.rb;
+	adORN[n]= G.ad;
+	trateORN[n]= G.trate;
+      }
+    }
+  }
+}
+
+//! join the threads of the CPU engine, e.g. before a fork(); the next step starts it again
+void stopCPUEngine()
+{
+  if (cpuPool == NULL) return;
+  syncStateCPU();
+  delete cpuPool;
+  cpuPool= NULL;
+}
+
+//! to be called after the GeNN variables were overwritten, e.g. from a state file
+void restoreStateCPU()
+{
+  if (cpuPool != NULL) initORNGlomeruli();
+}
+
+#endif
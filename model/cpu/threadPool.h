@@ -0,0 +1,188 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file threadPool.h
+
+\brief A small work-stealing thread pool for the CPU engine.
+
+parallelFor(n, f) runs f(task, worker) for task= 0 .. n-1 and returns when
+all tasks are done. Tasks are dealt out to the workers in contiguous blocks;
+a worker that runs out of tasks steals from the back of the other workers'
+queues. The calling thread takes part as worker 0. Which worker runs a task
+is not deterministic, so tasks must write to disjoint data. Idle workers
+spin for a while and then sleep on a condition variable until the next
+parallelFor(), so a pool between runs does not take CPU time.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class workStealingPool
+{
+ private:
+  struct taskQueue {
+    std::mutex m;
+    std::deque<unsigned int> q;
+    char pad[64];
+  };
+
+  typedef void (*taskFunc)(void *, unsigned int, unsigned int);
+
+  unsigned int workerN;
+  std::vector<std::thread> workers;
+  taskQueue *queues;
+  std::atomic<unsigned int> generation;
+  std::atomic<unsigned int> remaining;
+  std::atomic<unsigned int> busy;
+  std::atomic<bool> stop;
+  std::mutex sleepM; //!< guards the sleeps on wake and done
+  std::condition_variable wake; //!< workers wait for a new generation
+  std::condition_variable done; //!< the caller waits for busy == 0
+  std::atomic<unsigned int> sleepers; //!< threads asleep or about to sleep; notify only if > 0
+  taskFunc job;
+  void *jobData;
+
+  bool pop(unsigned int w, unsigned int &task) {
+    std::lock_guard<std::mutex> lock(queues[w].m);
+    if (queues[w].q.empty()) return false;
+    task= queues[w].q.front();
+    queues[w].q.pop_front();
+    return true;
+  }
+
+  bool steal(unsigned int w, unsigned int &task) {
+    for (unsigned int k= 1; k < workerN; k++) {
+      taskQueue &victim= queues[(w+k)%workerN];
+      std::lock_guard<std::mutex> lock(victim.m);
+      if (!victim.q.empty()) {
+	task= victim.q.back();
+	victim.q.pop_back();
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void work(unsigned int w) {
+    unsigned int task;
+    while (remaining.load(std::memory_order_acquire) > 0) {
+      if (pop(w, task) || steal(w, task)) {
+	job(jobData, task, w);
+	remaining.fetch_sub(1, std::memory_order_acq_rel);
+      }
+      else std::this_thread::yield();
+    }
+  }
+
+  //! spin, then yield; false once the budget is used up and the caller should sleep
+  static bool wait(unsigned int &spins) {
+    ++spins;
+    if (spins > 2000) return false;
+    if (spins > 1000) std::this_thread::yield();
+    return true;
+  }
+
+  bool idle(unsigned int seen) {
+    return (generation.load() == seen) && !stop.load();
+  }
+
+  void workerLoop(unsigned int w) {
+    unsigned int seen= 0;
+    while (true) {
+      unsigned int spins= 0;
+      while (idle(seen) && wait(spins));
+      if (idle(seen)) {
+	std::unique_lock<std::mutex> lock(sleepM);
+	sleepers.fetch_add(1);
+	while (idle(seen)) wake.wait(lock);
+	sleepers.fetch_sub(1);
+      }
+      if (stop.load(std::memory_order_acquire)) return;
+      seen= generation.load(std::memory_order_acquire);
+      work(w);
+      if ((busy.fetch_sub(1) == 1) && (sleepers.load() > 0)) {
+	std::lock_guard<std::mutex> lock(sleepM);
+	done.notify_one();
+      }
+    }
+  }
+
+  template <class F>
+  static void call(void *f, unsigned int task, unsigned int worker) {
+    (*(F *) f)(task, worker);
+  }
+
+ public:
+  explicit workStealingPool(unsigned int n): workerN(n < 1 ? 1 : n), generation(0), remaining(0), busy(0), stop(false), sleepers(0), job(NULL), jobData(NULL) {
+    queues= new taskQueue[workerN];
+    for (unsigned int w= 1; w < workerN; w++) {
+      workers.push_back(std::thread(&workStealingPool::workerLoop, this, w));
+    }
+  }
+
+  ~workStealingPool() {
+    stop.store(true, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleepM);
+      wake.notify_all();
+    }
+    for (unsigned int w= 0; w < workers.size(); w++) workers[w].join();
+    delete[] queues;
+  }
+
+  unsigned int size() const { return workerN; }
+
+  template <class F>
+  void parallelFor(unsigned int taskN, F &f) {
+    if ((workerN == 1) || (taskN < 2)) {
+      for (unsigned int i= 0; i < taskN; i++) f(i, 0);
+      return;
+    }
+    job= &call<F>;
+    jobData= (void *) &f;
+    for (unsigned int w= 0; w < workerN; w++) {
+      std::lock_guard<std::mutex> lock(queues[w].m);
+      for (unsigned int i= w*taskN/workerN; i < (w+1)*taskN/workerN; i++) {
+	queues[w].q.push_back(i);
+      }
+    }
+    remaining.store(taskN, std::memory_order_release);
+    busy.store(workerN-1, std::memory_order_release);
+    generation.fetch_add(1);
+    if (sleepers.load() > 0) {
+      std::lock_guard<std::mutex> lock(sleepM);
+      wake.notify_all();
+    }
+    work(0);
+    unsigned int spins= 0;
+    while ((busy.load(std::memory_order_acquire) > 0) && wait(spins));
+    if (busy.load(std::memory_order_acquire) > 0) {
+      std::unique_lock<std::mutex> lock(sleepM);
+      sleepers.fetch_add(1);
+      while (busy.load() > 0) done.wait(lock);
+      sleepers.fetch_sub(1);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#ifndef CONBIN_CC
+#define CONBIN_CC
+
+#include "conbin.h"
+#include <fstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CONBIN_HEADER 24
+
+conFile::conFile()
+{
+  map= NULL;
+  mapN= 0;
+  dir= NULL;
+  entryN= 0;
+}
+
+conFile::~conFile()
+{
+  close();
+}
+
+bool conFile::open(string name)
+{
+  close();
+  int fd= ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size < CONBIN_HEADER)) {
+    ::close(fd);
+    return false;
+  }
+  void *p= mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+  map= (unsigned char *) p;
+  mapN= st.st_size;
+  uint64_t dirOffset;
+  memcpy(&entryN, map+8, 4);
+  memcpy(&dirOffset, map+16, 8);
+  if ((strncmp((const char *) map, CONBIN_MAGIC, 8) != 0) || (dirOffset+(uint64_t) entryN*sizeof(conEntry) > mapN)) {
+    close();
+    return false;
+  }
+  dir= (const conEntry *) (map+dirOffset);
+  // every array must lie within the file
+  for (unsigned int i= 0; i < entryN; i++) {
+    const conEntry &e= dir[i];
+    bool ok= ((e.valueBytes == 4) || (e.valueBytes == 8)) && (e.values+e.nnz*e.valueBytes <= mapN);
+    if (e.kind == CONBIN_DENSE) ok= ok && (e.nnz == (uint64_t) e.rows*e.cols);
+    else if (e.kind == CONBIN_CSR) ok= ok && (e.indInG+(e.rows+1)*4 <= mapN) && (e.ind+e.nnz*4 <= mapN);
+    else ok= false;
+    if (!ok) {
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void conFile::close()
+{
+  if (map != NULL) munmap(map, mapN);
+  map= NULL;
+  mapN= 0;
+  dir= NULL;
+  entryN= 0;
+}
+
+//! the entry called name, NULL if there is none
+const conEntry *conFile::find(string name)
+{
+  for (unsigned int i= 0; i < entryN; i++) {
+    if (strncmp(dir[i].name, name.c_str(), sizeof(dir[i].name)) == 0) return dir+i;
+  }
+  return NULL;
+}
+
+//! whether the rows of CSR entry e are in order and its columns in range
+bool conFile::checkCSR(const conEntry *e)
+{
+  const unsigned int *iG= indInG(e), *id= ind(e);
+  if ((iG[0] != 0) || (iG[e->rows] != e->nnz)) return false;
+  for (unsigned int i= 0; i < e->rows; i++) {
+    if (iG[i+1] < iG[i]) return false;
+  }
+  for (uint64_t n= 0; n < e->nnz; n++) {
+    if (id[n] >= e->cols) return false;
+  }
+  return true;
+}
+
+// keep a copy of n bytes from p; returns its offset relative to the start of the arrays
+uint64_t conWriter::add(const void *p, uint64_t n)
+{
+  uint64_t offset= 0;
+  for (unsigned int i= 0; i < arrays.size(); i++) offset+= arrays[i].size();
+  arrays.push_back(vector<unsigned char>((const unsigned char *) p, (const unsigned char *) p+n));
+  arrays.back().resize((n+CONBIN_ALIGN-1)/CONBIN_ALIGN*CONBIN_ALIGN, 0);
+  return offset;
+}
+
+conEntry conWriter::entry(string name, unsigned int kind, unsigned int valueBytes, unsigned int rows, unsigned int cols, uint64_t nnz)
+{
+  conEntry e;
+  memset(&e, 0, sizeof(e));
+  strncpy(e.name, name.c_str(), sizeof(e.name)-1);
+  e.kind= kind;
+  e.valueBytes= valueBytes;
+  e.rows= rows;
+  e.cols= cols;
+  e.nnz= nnz;
+  return e;
+}
+
+bool conWriter::write(string name)
+{
+  uint32_t n[2]= { (uint32_t) dir.size(), 0 };
+  uint64_t dirOffset= CONBIN_ALIGN;
+  uint64_t arrayOffset= (dirOffset+dir.size()*sizeof(conEntry)+CONBIN_ALIGN-1)/CONBIN_ALIGN*CONBIN_ALIGN;
+  // array offsets relative to the file
+  vector<conEntry> d(dir);
+  for (unsigned int i= 0; i < d.size(); i++) {
+    if (d[i].kind == CONBIN_CSR) {
+      d[i].indInG+= arrayOffset;
+      d[i].ind+= arrayOffset;
+    }
+    d[i].values+= arrayOffset;
+  }
+  vector<char> pad(CONBIN_ALIGN, 0);
+  ofstream os(name.c_str(), ios::binary);
+  if (!os.good()) return false;
+  os.write(CONBIN_MAGIC, 8);
+  os.write((const char *) n, sizeof(n));
+  os.write((const char *) &dirOffset, 8);
+  os.write(&pad[0], dirOffset-CONBIN_HEADER);
+  if (!d.empty()) os.write((const char *) &d[0], d.size()*sizeof(conEntry));
+  os.write(&pad[0], arrayOffset-dirOffset-d.size()*sizeof(conEntry));
+  for (unsigned int i= 0; i < arrays.size(); i++) {
+    if (!arrays[i].empty()) os.write((const char *) &arrays[i][0], arrays[i].size());
+  }
+  os.close();
+  return os.good();
+}
+
+//! whether name starts like a connectivity file
+bool isConFile(string name)
+{
+  char magic[8];
+  ifstream is(name.c_str(), ios::binary);
+  is.read(magic, 8);
+  return is.good() && (strncmp(magic, CONBIN_MAGIC, 8) == 0);
+}
+
+#endif
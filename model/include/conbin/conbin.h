@@ -0,0 +1,115 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Connectivity files (.con): named dense matrices (e.g. the glomerular
+  hLN-PN matrix) and synapse groups in compressed sparse row form, laid out
+  so that they can be mapped into memory and used where they are.
+
+  Layout (numbers in the byte order of the machine, little endian on x86):
+  header     "ALCON001", uint32 entryN, uint32 0, uint64 directory offset
+  directory  per entry 64 bytes: char name[16], uint32 kind, uint32 value
+             bytes (4: float, 8: double), uint32 rows, uint32 cols,
+             uint64 nnz, uint64 offsets of indInG, ind and values
+  arrays     dense: values[rows][cols]; CSR: uint32 indInG[rows+1],
+             uint32 ind[nnz] (column of each entry), values[nnz]
+
+  Every array starts at a multiple of CONBIN_ALIGN bytes; unused offsets
+  are 0.
+
+--------------------------------------------------------------------------*/
+
+#ifndef CONBIN_H
+#define CONBIN_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <cstring>
+
+using namespace std;
+
+#define CONBIN_MAGIC "ALCON001"
+#define CONBIN_ALIGN 64
+
+enum conKind {CONBIN_DENSE= 1, CONBIN_CSR= 2};
+
+struct conEntry {
+  char name[16];
+  uint32_t kind;
+  uint32_t valueBytes;
+  uint32_t rows;
+  uint32_t cols;
+  uint64_t nnz;
+  uint64_t indInG;
+  uint64_t ind;
+  uint64_t values;
+};
+
+//! a connectivity file mapped copy-on-write: arrays can be changed in memory, the file stays as it is
+class conFile
+{
+ private:
+  unsigned char *map;
+  size_t mapN;
+  const conEntry *dir;
+  unsigned int entryN;
+
+ public:
+  conFile();
+  ~conFile();
+  bool open(string);
+  bool is_open() { return map != NULL; }
+  void close();
+  unsigned int entries() { return entryN; }
+  const conEntry *entry(unsigned int i) { return dir+i; }
+  const conEntry *find(string);
+  bool checkCSR(const conEntry *);
+  unsigned int *indInG(const conEntry *e) { return (unsigned int *) (map+e->indInG); }
+  unsigned int *ind(const conEntry *e) { return (unsigned int *) (map+e->ind); }
+  void *values(const conEntry *e) { return map+e->values; }
+  double value(const conEntry *e, uint64_t n) { return (e->valueBytes == 8) ? ((const double *) values(e))[n] : ((const float *) values(e))[n]; }
+};
+
+//! collects matrices and synapse groups and writes them as a connectivity file
+class conWriter
+{
+ private:
+  vector<conEntry> dir;
+  vector<vector<unsigned char> > arrays;
+
+  uint64_t add(const void *, uint64_t);
+
+ public:
+  template <class T>
+  void addDense(string name, unsigned int rows, unsigned int cols, const T *g) {
+    conEntry e= entry(name, CONBIN_DENSE, sizeof(T), rows, cols, (uint64_t) rows*cols);
+    e.values= add(g, e.nnz*sizeof(T));
+    dir.push_back(e);
+  }
+  template <class T>
+  void addCSR(string name, unsigned int rows, unsigned int cols, const unsigned int *indInG, const unsigned int *ind, const T *g) {
+    conEntry e= entry(name, CONBIN_CSR, sizeof(T), rows, cols, indInG[rows]);
+    e.indInG= add(indInG, (rows+1)*sizeof(unsigned int));
+    e.ind= add(ind, e.nnz*sizeof(unsigned int));
+    e.values= add(g, e.nnz*sizeof(T));
+    dir.push_back(e);
+  }
+  conEntry entry(string, unsigned int, unsigned int, unsigned int, unsigned int, uint64_t);
+  bool write(string);
+};
+
+bool isConFile(string);
+
+#endif
@@ -0,0 +1,183 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#ifndef MATBIN_CC
+#define MATBIN_CC
+
+#include "matbin.h"
+#include <cstring>
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+matWriter::matWriter()
+{
+  memset(&h, 0, sizeof(h));
+}
+
+matWriter::~matWriter()
+{
+  close();
+}
+
+//--------------------------------------------------------------------------
+/*! \brief Start the file name with the columns names (the first one the
+  time), values of valueBytes (4 or 8) bytes and, if dt > 0, row i at time
+  t0+i*dt.
+ */
+//--------------------------------------------------------------------------
+
+bool matWriter::open(string name, const vector<string> &names, unsigned int valueBytes, double t0, double dt)
+{
+  close();
+  string nm;
+  for (unsigned int i= 0; i < names.size(); i++) nm+= names[i]+"\n";
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, MATBIN_MAGIC, 8);
+  h.valueBytes= (valueBytes == 4) ? 4 : 8;
+  h.cols= names.size();
+  h.rows= 0;
+  h.t0= t0;
+  h.dt= dt;
+  h.names= sizeof(matHeader);
+  h.namesBytes= nm.size();
+  h.data= (h.names+h.namesBytes+MATBIN_ALIGN-1)/MATBIN_ALIGN*MATBIN_ALIGN;
+  os.open(name.c_str(), ios::binary);
+  if (!os.good()) return false;
+  os.write((const char *) &h, sizeof(h));
+  os.write(nm.data(), nm.size());
+  vector<char> pad(h.data-h.names-h.namesBytes, 0);
+  if (!pad.empty()) os.write(&pad[0], pad.size());
+  buf.resize(h.cols*h.valueBytes);
+  return os.good();
+}
+
+//! a row of cols values
+void matWriter::row(const double *v)
+{
+  if (h.valueBytes == 8) os.write((const char *) v, h.cols*8);
+  else {
+    float *f= (float *) &buf[0];
+    for (unsigned int i= 0; i < h.cols; i++) f[i]= (float) v[i];
+    os.write(&buf[0], h.cols*4);
+  }
+  h.rows++;
+}
+
+//! a row of the time t and cols-1 values
+void matWriter::row(double t, const double *v)
+{
+  if (h.valueBytes == 8) {
+    os.write((const char *) &t, 8);
+    os.write((const char *) v, (h.cols-1)*8);
+  }
+  else {
+    float *f= (float *) &buf[0];
+    f[0]= (float) t;
+    for (unsigned int i= 1; i < h.cols; i++) f[i]= (float) v[i-1];
+    os.write(&buf[0], h.cols*4);
+  }
+  h.rows++;
+}
+
+//! write the number of rows into the header and close the file
+void matWriter::close()
+{
+  if (!os.is_open()) return;
+  os.seekp(offsetof(matHeader, rows));
+  os.write((const char *) &h.rows, 8);
+  os.close();
+}
+
+matFile::matFile()
+{
+  map= NULL;
+  mapN= 0;
+  memset(&h, 0, sizeof(h));
+}
+
+matFile::~matFile()
+{
+  close();
+}
+
+bool matFile::open(string name)
+{
+  close();
+  int fd= ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t) sizeof(matHeader))) {
+    ::close(fd);
+    return false;
+  }
+  void *p= mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+  map= (unsigned char *) p;
+  mapN= st.st_size;
+  memcpy(&h, map, sizeof(h));
+  bool ok= (strncmp(h.magic, MATBIN_MAGIC, 8) == 0) && ((h.valueBytes == 4) || (h.valueBytes == 8)) && (h.cols > 0);
+  ok= ok && (h.names+h.namesBytes <= mapN) && (h.data <= mapN);
+  if (ok) {
+    uint64_t rowBytes= (uint64_t) h.cols*h.valueBytes;
+    // a file that was not closed has the rows it holds
+    if (h.rows == 0) h.rows= (mapN-h.data)/rowBytes;
+    ok= (h.data+h.rows*rowBytes <= mapN);
+  }
+  if (!ok) {
+    close();
+    return false;
+  }
+  colName.clear();
+  const char *c= (const char *) map+h.names, *e= c+h.namesBytes;
+  while (c < e) {
+    const char *n= (const char *) memchr(c, '\n', e-c);
+    if (n == NULL) n= e;
+    colName.push_back(string(c, n-c));
+    c= n+1;
+  }
+  colName.resize(h.cols);
+  madvise(map, mapN, MADV_SEQUENTIAL);
+  return true;
+}
+
+void matFile::close()
+{
+  if (map != NULL) munmap(map, mapN);
+  map= NULL;
+  mapN= 0;
+  colName.clear();
+}
+
+//! the column called name, -1 if there is none
+int matFile::column(string name)
+{
+  for (unsigned int c= 0; c < colName.size(); c++) {
+    if (colName[c] == name) return c;
+  }
+  return -1;
+}
+
+//! whether name starts like a matrix file
+bool isMatFile(string name)
+{
+  char magic[8];
+  ifstream is(name.c_str(), ios::binary);
+  is.read(magic, 8);
+  return is.good() && (strncmp(magic, MATBIN_MAGIC, 8) == 0);
+}
+
+#endif
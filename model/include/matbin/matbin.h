@@ -0,0 +1,109 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Binary matrix files (.out.cmpb, .sdfb, .rateb): the rows of the "t value
+  value ..." text files (.out.cmp, .sdf, .rate) as one contiguous array,
+  with a header that describes them, so that they can be mapped into
+  memory (numpy.memmap, matFile) and used where they are.
+
+  Layout (numbers in the byte order of the machine, little endian on x86):
+  header   64 bytes: "ALMAT001", uint32 value bytes (4: float, 8: double),
+           uint32 cols, uint64 rows, double t0, double dt, uint64 names
+           offset, uint64 names bytes, uint64 data offset
+  names    the cols column names, each ended by '\n' (column 0 is "t")
+  data     values[rows][cols], from data offset (a multiple of
+           MATBIN_ALIGN bytes) to the end of the file
+
+  Row i is at time t0+i*dt when dt > 0; column 0 holds the times in any
+  case. rows is written when the file is closed; while it is 0 the number
+  of rows follows from the file size.
+
+--------------------------------------------------------------------------*/
+
+#ifndef MATBIN_H
+#define MATBIN_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+#define MATBIN_MAGIC "ALMAT001"
+#define MATBIN_ALIGN 64
+
+struct matHeader {
+  char magic[8];
+  uint32_t valueBytes;
+  uint32_t cols;
+  uint64_t rows;
+  double t0;
+  double dt;
+  uint64_t names;
+  uint64_t namesBytes;
+  uint64_t data;
+};
+
+//! writes a matrix file row by row
+class matWriter
+{
+ private:
+  ofstream os;
+  matHeader h;
+  vector<char> buf;
+
+ public:
+  matWriter();
+  ~matWriter();
+  bool open(string, const vector<string> &, unsigned int valueBytes= 8, double t0= 0.0, double dt= 0.0);
+  bool is_open() { return os.is_open(); }
+  void row(const double *);
+  void row(double, const double *);
+  void close();
+};
+
+//! a matrix file mapped read-only
+class matFile
+{
+ private:
+  unsigned char *map;
+  size_t mapN;
+  matHeader h;
+  vector<string> colName;
+
+ public:
+  matFile();
+  ~matFile();
+  bool open(string);
+  bool is_open() { return map != NULL; }
+  void close();
+  uint64_t rows() { return h.rows; }
+  unsigned int cols() { return h.cols; }
+  unsigned int valueBytes() { return h.valueBytes; }
+  double t0() { return h.t0; }
+  double dt() { return h.dt; }
+  const string &name(unsigned int c) { return colName[c]; }
+  int column(string);
+  const void *data() { return map+h.data; }
+  double value(uint64_t r, unsigned int c) {
+    uint64_t n= r*h.cols+c;
+    return (h.valueBytes == 8) ? ((const double *) data())[n] : ((const float *) data())[n];
+  }
+};
+
+bool isMatFile(string);
+
+#endif
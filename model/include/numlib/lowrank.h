@@ -0,0 +1,173 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Rank k approximation A ~ U V of a dense row major m x n matrix A, with U
+  m x k and V k x n. The range of A is found with a randomized range finder
+  (Halko, Martinsson & Tropp 2011: Y= (A A^T)^q A Omega with k+p Gaussian
+  test vectors, orthonormalized after every product); the small matrix
+  B= Q^T A is then decomposed with one-sided Jacobi SVD and truncated to
+  its k largest singular values. If k+p >= min(m, n) the SVD is of A
+  itself. The test vectors come from Philox, so the result is
+  reproducible.
+
+--------------------------------------------------------------------------*/
+
+#ifndef LOWRANK_H
+#define LOWRANK_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "philox.h"
+
+using namespace std;
+
+// orthonormalize the c columns of the row major r x c matrix Y (modified Gram-Schmidt); columns that vanish are set to 0
+inline void lowrankOrthonormalize(vector<double> &Y, unsigned int r, unsigned int c)
+{
+  for (unsigned int j= 0; j < c; j++) {
+    for (unsigned int l= 0; l < j; l++) {
+      double d= 0.0;
+      for (unsigned int i= 0; i < r; i++) d+= Y[i*c+l]*Y[i*c+j];
+      for (unsigned int i= 0; i < r; i++) Y[i*c+j]-= d*Y[i*c+l];
+    }
+    double nrm= 0.0;
+    for (unsigned int i= 0; i < r; i++) nrm+= Y[i*c+j]*Y[i*c+j];
+    nrm= sqrt(nrm);
+    for (unsigned int i= 0; i < r; i++) Y[i*c+j]= (nrm > 1e-300) ? Y[i*c+j]/nrm : 0.0;
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! one-sided Jacobi SVD of the row major r x c matrix M= W S Z^T: on return
+  the columns of M are W S (in place), s the singular values and Z (c x c,
+  row major) the right singular vectors
+ */
+//--------------------------------------------------------------------------
+
+inline void lowrankJacobi(vector<double> &M, unsigned int r, unsigned int c, vector<double> &s, vector<double> &Z)
+{
+  Z.assign(c*c, 0.0);
+  for (unsigned int j= 0; j < c; j++) Z[j*c+j]= 1.0;
+  for (int sweep= 0; sweep < 60; sweep++) {
+    double off= 0.0;
+    for (unsigned int p= 0; p < c; p++) {
+      for (unsigned int q= p+1; q < c; q++) {
+	double a= 0.0, b= 0.0, g= 0.0;
+	for (unsigned int i= 0; i < r; i++) {
+	  a+= M[i*c+p]*M[i*c+p];
+	  b+= M[i*c+q]*M[i*c+q];
+	  g+= M[i*c+p]*M[i*c+q];
+	}
+	if ((g == 0.0) || (fabs(g) <= 1e-15*sqrt(a*b))) continue;
+	off= max(off, fabs(g)/sqrt(a*b));
+	double zeta= (b-a)/(2.0*g);
+	double t= ((zeta >= 0.0) ? 1.0 : -1.0)/(fabs(zeta)+sqrt(1.0+zeta*zeta));
+	double cs= 1.0/sqrt(1.0+t*t), sn= cs*t;
+	for (unsigned int i= 0; i < r; i++) {
+	  double x= M[i*c+p], y= M[i*c+q];
+	  M[i*c+p]= cs*x-sn*y;
+	  M[i*c+q]= sn*x+cs*y;
+	}
+	for (unsigned int i= 0; i < c; i++) {
+	  double x= Z[i*c+p], y= Z[i*c+q];
+	  Z[i*c+p]= cs*x-sn*y;
+	  Z[i*c+q]= sn*x+cs*y;
+	}
+      }
+    }
+    if (off < 1e-15) break;
+  }
+  s.assign(c, 0.0);
+  for (unsigned int j= 0; j < c; j++) {
+    for (unsigned int i= 0; i < r; i++) s[j]+= M[i*c+j]*M[i*c+j];
+    s[j]= sqrt(s[j]);
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! A ~ U V with rank k (k <= min(m, n)), p oversampling vectors and q
+  power iterations; returns the singular values found (largest first)
+ */
+//--------------------------------------------------------------------------
+
+inline vector<double> lowrank(const vector<double> &A, unsigned int m, unsigned int n, unsigned int k, vector<double> &U, vector<double> &V, unsigned int p= 10, unsigned int q= 2)
+{
+  unsigned int l= k+p;
+  vector<double> Q; // m x l, orthonormal columns spanning the range of A
+  if (l >= min(m, n)) {
+    l= m;
+    Q.assign(m*m, 0.0);
+    for (unsigned int i= 0; i < m; i++) Q[i*m+i]= 1.0;
+  }
+  else {
+    vector<double> Om(n*l), Z(n*l);
+    for (unsigned int i= 0; i < n*l; i++) Om[i]= philoxNormal(0x4c4f57524e4bULL, i, 0);
+    Q.assign(m*l, 0.0);
+    for (unsigned int i= 0; i < m; i++) {
+      for (unsigned int j= 0; j < n; j++) {
+	for (unsigned int c= 0; c < l; c++) Q[i*l+c]+= A[i*n+j]*Om[j*l+c];
+      }
+    }
+    lowrankOrthonormalize(Q, m, l);
+    for (unsigned int it= 0; it < q; it++) {
+      // Z= A^T Q, Q= A Z
+      fill(Z.begin(), Z.end(), 0.0);
+      for (unsigned int i= 0; i < m; i++) {
+	for (unsigned int j= 0; j < n; j++) {
+	  for (unsigned int c= 0; c < l; c++) Z[j*l+c]+= A[i*n+j]*Q[i*l+c];
+	}
+      }
+      lowrankOrthonormalize(Z, n, l);
+      fill(Q.begin(), Q.end(), 0.0);
+      for (unsigned int i= 0; i < m; i++) {
+	for (unsigned int j= 0; j < n; j++) {
+	  for (unsigned int c= 0; c < l; c++) Q[i*l+c]+= A[i*n+j]*Z[j*l+c];
+	}
+      }
+      lowrankOrthonormalize(Q, m, l);
+    }
+  }
+  // B^T= A^T Q (n x l); its SVD B^T= W S Z^T gives A ~ Q B= (Q Z) S W^T
+  vector<double> Bt(n*l, 0.0), s, Z;
+  for (unsigned int i= 0; i < m; i++) {
+    for (unsigned int j= 0; j < n; j++) {
+      for (unsigned int c= 0; c < l; c++) Bt[j*l+c]+= A[i*n+j]*Q[i*l+c];
+    }
+  }
+  lowrankJacobi(Bt, n, l, s, Z);
+  vector<unsigned int> order(l);
+  for (unsigned int c= 0; c < l; c++) order[c]= c;
+  for (unsigned int a= 0; a < l; a++) {
+    for (unsigned int b= a+1; b < l; b++) {
+      if (s[order[b]] > s[order[a]]) swap(order[a], order[b]);
+    }
+  }
+  // U= Q Z (first k columns), V= S W^T= columns of Bt transposed
+  U.assign(m*k, 0.0);
+  V.assign(k*n, 0.0);
+  vector<double> sv(k);
+  for (unsigned int r= 0; r < k; r++) {
+    unsigned int c= order[r];
+    sv[r]= s[c];
+    for (unsigned int i= 0; i < m; i++) {
+      for (unsigned int d= 0; d < l; d++) U[i*k+r]+= Q[i*l+d]*Z[d*l+c];
+    }
+    for (unsigned int j= 0; j < n; j++) V[r*n+j]= Bt[j*l+c];
+  }
+  return sv;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Philox4x32-10 counter based random number generator (Salmon et al. 2011,
+  "Parallel random numbers: as easy as 1, 2, 3"). The output is a pure
+  function of a 64 bit key and a 128 bit counter, so streams can be
+  evaluated in any order, in parallel and in SIMD batches and still give
+  the same numbers. philox4x32_batch() is written such that the compiler
+  can vectorize it.
+
+--------------------------------------------------------------------------*/
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+#include <cmath>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+// 10 rounds of Philox4x32 on counter c with key k; result in c
+inline void philox4x32(uint32_t c[4], uint32_t k0, uint32_t k1)
+{
+  for (int r= 0; r < 10; r++) {
+    uint64_t p0= (uint64_t) PHILOX_M0*c[0];
+    uint64_t p1= (uint64_t) PHILOX_M1*c[2];
+    uint32_t n0= (uint32_t) (p1 >> 32) ^ c[1] ^ k0;
+    uint32_t n2= (uint32_t) (p0 >> 32) ^ c[3] ^ k1;
+    c[1]= (uint32_t) p1;
+    c[3]= (uint32_t) p0;
+    c[0]= n0;
+    c[2]= n2;
+    k0+= PHILOX_W0;
+    k1+= PHILOX_W1;
+  }
+}
+
+// 64 random bits for counter (i, step) under key
+inline uint64_t philox64(uint64_t key, uint32_t i, uint64_t step)
+{
+  uint32_t c[4]= {i, (uint32_t) step, (uint32_t) (step >> 32), 0};
+  philox4x32(c, (uint32_t) key, (uint32_t) (key >> 32));
+  return ((uint64_t) c[1] << 32) | c[0];
+}
+
+// standard normal number for counter (i, stream) under key, by Box-Muller on the two halves of philox64
+inline double philoxNormal(uint64_t key, uint32_t i, uint64_t stream)
+{
+  uint64_t x= philox64(key, i, stream);
+  double u1= ((double) (uint32_t) x+0.5)/4294967296.0;
+  double u2= (double) (uint32_t) (x >> 32)/4294967296.0;
+  return sqrt(-2.0*log(u1))*cos(6.283185307179586*u2);
+}
+
+// philox64(key, i0+j, step) for j= 0 .. n-1 into out
+inline void philox4x32_batch(uint64_t key, uint32_t i0, uint64_t step, unsigned int n, uint64_t *out)
+{
+  const uint32_t s0= (uint32_t) step, s1= (uint32_t) (step >> 32);
+  const uint32_t key0= (uint32_t) key, key1= (uint32_t) (key >> 32);
+  for (unsigned int j= 0; j < n; j++) {
+    uint32_t c0= i0+j, c1= s0, c2= s1, c3= 0;
+    uint32_t k0= key0, k1= key1;
+    for (int r= 0; r < 10; r++) {
+      uint64_t p0= (uint64_t) PHILOX_M0*c0;
+      uint64_t p1= (uint64_t) PHILOX_M1*c2;
+      uint32_t n0= (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+      uint32_t n2= (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+      c1= (uint32_t) p1;
+      c3= (uint32_t) p0;
+      c0= n0;
+      c2= n2;
+      k0+= PHILOX_W0;
+      k1+= PHILOX_W1;
+    }
+    out[j]= ((uint64_t) c1 << 32) | c0;
+  }
+}
+
+// philox64(key[k], j, step) for k= 0 .. K-1 and j= 0 .. n-1 into out[k*n+j]
+inline void philox4x32_batch(const uint64_t *key, unsigned int K, uint64_t step, unsigned int n, uint64_t *out)
+{
+  for (unsigned int k= 0; k < K; k++) philox4x32_batch(key[k], 0, step, n, out+k*n);
+}
+
+#endif
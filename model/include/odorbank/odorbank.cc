@@ -0,0 +1,130 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#ifndef ODORBANK_CC
+#define ODORBANK_CC
+
+#include "odorbank.h"
+#include <fstream>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ODORBANK_HEADER 40
+
+odorBank::odorBank()
+{
+  map= NULL;
+  mapN= 0;
+  odorN= 0;
+  gloN= 0;
+  paraN= 0;
+  dataOffset= 0;
+  odorStride= 0;
+}
+
+odorBank::~odorBank()
+{
+  close();
+}
+
+bool odorBank::open(string name)
+{
+  close();
+  int fd= ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size < ODORBANK_HEADER)) {
+    ::close(fd);
+    return false;
+  }
+  void *p= mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+  map= (const unsigned char *) p;
+  mapN= st.st_size;
+  // the odors are read in no particular order
+  madvise(p, mapN, MADV_RANDOM);
+  uint32_t n[4];
+  if (strncmp((const char *) map, ODORBANK_MAGIC, 8) != 0) {
+    close();
+    return false;
+  }
+  memcpy(n, map+8, sizeof(n));
+  memcpy(&dataOffset, map+24, 8);
+  memcpy(&odorStride, map+32, 8);
+  odorN= n[0];
+  gloN= n[1];
+  paraN= n[2];
+  if ((dataOffset % ODORBANK_ALIGN != 0) || (odorStride % ODORBANK_ALIGN != 0) || (odorStride < (uint64_t) gloN*paraN*sizeof(double)) || (dataOffset+odorN*odorStride > mapN)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void odorBank::close()
+{
+  if (map != NULL) munmap((void *) map, mapN);
+  map= NULL;
+  mapN= 0;
+  odorN= 0;
+}
+
+//! start reading odor i from disk ahead of its first use
+void odorBank::willNeed(unsigned int i)
+{
+  long page= sysconf(_SC_PAGESIZE);
+  uint64_t from= dataOffset+i*odorStride;
+  uint64_t to= from+odorStride;
+  from-= from % page;
+  madvise((void *) (map+from), to-from, MADV_WILLNEED);
+}
+
+//! read the gloN lines of paraN numbers of an odor text file into pp
+bool readOdorFile(string name, unsigned int gloN, unsigned int paraN, double *pp)
+{
+  ifstream is(name.c_str());
+  if (!is.good()) return false;
+  for (unsigned int j= 0; j < gloN*paraN; j++) {
+    is >> pp[j];
+  }
+  return !is.fail();
+}
+
+//! write the odors in pp (odorN*gloN*paraN values) to the bank name
+bool writeOdorBank(string name, unsigned int odorN, unsigned int gloN, unsigned int paraN, const vector<double> &pp)
+{
+  uint64_t dataOffset= ODORBANK_ALIGN;
+  uint64_t odorBytes= (uint64_t) gloN*paraN*sizeof(double);
+  uint64_t odorStride= (odorBytes+ODORBANK_ALIGN-1)/ODORBANK_ALIGN*ODORBANK_ALIGN;
+  uint32_t n[4]= { odorN, gloN, paraN, 0 };
+  vector<char> pad(ODORBANK_ALIGN, 0);
+  ofstream os(name.c_str(), ios::binary);
+  if (!os.good()) return false;
+  os.write(ODORBANK_MAGIC, 8);
+  os.write((const char *) n, sizeof(n));
+  os.write((const char *) &dataOffset, 8);
+  os.write((const char *) &odorStride, 8);
+  os.write(&pad[0], dataOffset-ODORBANK_HEADER);
+  for (unsigned int i= 0; i < odorN; i++) {
+    os.write((const char *) &pp[(uint64_t) i*gloN*paraN], odorBytes);
+    os.write(&pad[0], odorStride-odorBytes);
+  }
+  os.close();
+  return os.good();
+}
+
+#endif
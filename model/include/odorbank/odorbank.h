@@ -0,0 +1,69 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Odor banks (.odb): all odors of an odor directory (odor<i><ext> text
+  files of gloN lines with paraN numbers) in one binary file that is
+  mapped into memory, so that only the pages of odors that are used are
+  ever read from disk.
+
+  Layout (numbers in the byte order of the machine, little endian on x86):
+  header   "ALODB001", uint32 odorN, uint32 gloN, uint32 paraN, uint32 0,
+           uint64 data offset, uint64 odor stride (bytes), zero padding
+  data     per odor double [gloN][paraN], zero padded to the odor stride
+
+  The data offset and the odor stride are multiples of ODORBANK_ALIGN, so
+  every odor starts on its own cache line.
+
+--------------------------------------------------------------------------*/
+
+#ifndef ODORBANK_H
+#define ODORBANK_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+#define ODORBANK_MAGIC "ALODB001"
+#define ODORBANK_ALIGN 64
+
+class odorBank
+{
+ private:
+  const unsigned char *map;
+  size_t mapN;
+
+ public:
+  unsigned int odorN;
+  unsigned int gloN;
+  unsigned int paraN;
+  uint64_t dataOffset;
+  uint64_t odorStride; //!< bytes from one odor to the next
+
+  odorBank();
+  ~odorBank();
+  bool open(string);
+  bool is_open() { return map != NULL; }
+  void close();
+  //! the gloN*paraN values of odor i, glomerulus by glomerulus
+  const double *odor(unsigned int i) { return (const double *) (map+dataOffset+i*odorStride); }
+  void willNeed(unsigned int);
+};
+
+bool readOdorFile(string, unsigned int, unsigned int, double *);
+bool writeOdorBank(string, unsigned int, unsigned int, unsigned int, const vector<double> &);
+
+#endif
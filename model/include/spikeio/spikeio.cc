@@ -0,0 +1,285 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+#ifndef SPIKEIO_CC
+#define SPIKEIO_CC
+
+#include "spikeio.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <cassert>
+
+inline void putVarint(vector<unsigned char> &b, uint64_t x)
+{
+  while (x >= 128) {
+    b.push_back((unsigned char) (x | 128));
+    x>>= 7;
+  }
+  b.push_back((unsigned char) x);
+}
+
+inline uint64_t getVarint(const unsigned char *&p)
+{
+  uint64_t x= 0;
+  int shift= 0;
+  while (*p & 128) {
+    x|= (uint64_t) (*p++ & 127) << shift;
+    shift+= 7;
+  }
+  x|= (uint64_t) (*p++) << shift;
+  return x;
+}
+
+template <class T>
+inline void putRaw(ofstream &os, T x)
+{
+  os.write((const char *) &x, sizeof(T));
+}
+
+template <class T>
+inline T getRaw(ifstream &is)
+{
+  T x;
+  is.read((char *) &x, sizeof(T));
+  return x;
+}
+
+//--------------------------------------------------------------------------
+// spikeWriter
+//--------------------------------------------------------------------------
+
+spikeWriter::spikeWriter(): neuronN(0), blockSteps(0), dt(0.0), neuronIndex(false), block(0), lastStep(0), spikeN(0), blockSpikeN(0)
+{
+}
+
+spikeWriter::~spikeWriter()
+{
+  if (os.is_open()) close();
+}
+
+void spikeWriter::open(string name, unsigned int N, double _dt, unsigned int _blockSteps, bool _neuronIndex)
+{
+  os.open(name.c_str(), ios::binary);
+  if (!os.good()) {
+    cerr << "could not open spike file " << name << " ... exiting" << endl;
+    exit(1);
+  }
+  neuronN= N;
+  dt= _dt;
+  blockSteps= (_blockSteps > 0) ? _blockSteps : 1;
+  neuronIndex= _neuronIndex;
+  block= 0;
+  lastStep= 0;
+  spikeN= 0;
+  blockSpikeN= 0;
+  buf.clear();
+  index.clear();
+  neuronBlocks.clear();
+  if (neuronIndex) neuronBlocks.resize(neuronN);
+  os.write(SPIKEIO_MAGIC, 8);
+  putRaw<uint32_t>(os, neuronN);
+  putRaw<uint32_t>(os, blockSteps);
+  putRaw<double>(os, dt);
+}
+
+void spikeWriter::flushBlock()
+{
+  if (buf.empty()) return;
+  spikeBlock_t b;
+  b.offset= os.tellp();
+  b.step0= block*blockSteps;
+  b.spikeN= blockSpikeN;
+  b.byteN= buf.size();
+  os.write((const char *) &buf[0], buf.size());
+  index.push_back(b);
+  buf.clear();
+  blockSpikeN= 0;
+}
+
+// the spikes ids[0..n-1] of the step at time t; steps must come in order
+void spikeWriter::write(double t, const unsigned int *id, unsigned int n)
+{
+  if (n == 0) return;
+  uint64_t step= (uint64_t) floor(t/dt+0.5);
+  if (step/blockSteps != block) {
+    flushBlock();
+    block= step/blockSteps;
+  }
+  if (buf.empty()) lastStep= block*blockSteps;
+  ids.assign(id, id+n);
+  sort(ids.begin(), ids.end());
+  putVarint(buf, step-lastStep);
+  putVarint(buf, n);
+  unsigned int last= 0;
+  for (unsigned int i= 0; i < n; i++) {
+    putVarint(buf, ids[i]-last);
+    last= ids[i];
+    if (neuronIndex) {
+      assert(ids[i] < neuronN);
+      vector<uint64_t> &nb= neuronBlocks[ids[i]];
+      if (nb.empty() || (nb.back() != index.size())) nb.push_back(index.size());
+    }
+  }
+  lastStep= step;
+  spikeN+= n;
+  blockSpikeN+= n;
+}
+
+void spikeWriter::close()
+{
+  flushBlock();
+  uint64_t indexOffset= os.tellp();
+  for (unsigned int i= 0; i < index.size(); i++) {
+    putRaw<uint64_t>(os, index[i].offset);
+    putRaw<uint64_t>(os, index[i].step0);
+    putRaw<uint64_t>(os, index[i].spikeN);
+    putRaw<uint64_t>(os, index[i].byteN);
+  }
+  uint64_t neuronOffset= 0;
+  if (neuronIndex) {
+    neuronOffset= os.tellp();
+    vector<unsigned char> blob;
+    vector<uint64_t> off(neuronN+1);
+    for (unsigned int i= 0; i < neuronN; i++) {
+      off[i]= blob.size();
+      const vector<uint64_t> &nb= neuronBlocks[i];
+      putVarint(blob, nb.size());
+      uint64_t last= 0;
+      for (unsigned int j= 0; j < nb.size(); j++) {
+	putVarint(blob, nb[j]-last);
+	last= nb[j];
+      }
+    }
+    off[neuronN]= blob.size();
+    for (unsigned int i= 0; i <= neuronN; i++) putRaw<uint64_t>(os, off[i]);
+    if (!blob.empty()) os.write((const char *) &blob[0], blob.size());
+  }
+  putRaw<uint64_t>(os, indexOffset);
+  putRaw<uint64_t>(os, index.size());
+  putRaw<uint64_t>(os, neuronOffset);
+  putRaw<uint64_t>(os, spikeN);
+  os.write(SPIKEIO_END, 8);
+  os.close();
+}
+
+//--------------------------------------------------------------------------
+// spikeReader
+//--------------------------------------------------------------------------
+
+bool spikeReader::open(string name)
+{
+  is.open(name.c_str(), ios::binary);
+  if (!is.good()) return false;
+  char magic[8];
+  is.read(magic, 8);
+  if (strncmp(magic, SPIKEIO_MAGIC, 8) != 0) return false;
+  neuronN= getRaw<uint32_t>(is);
+  blockSteps= getRaw<uint32_t>(is);
+  dt= getRaw<double>(is);
+  is.seekg(-40, ios::end);
+  uint64_t fileEnd= (uint64_t) is.tellg()+40;
+  uint64_t indexOffset= getRaw<uint64_t>(is);
+  uint64_t blockN= getRaw<uint64_t>(is);
+  uint64_t neuronIndexOffset= getRaw<uint64_t>(is);
+  spikeN= getRaw<uint64_t>(is);
+  is.read(magic, 8);
+  if (!is.good() || (strncmp(magic, SPIKEIO_END, 8) != 0)) return false;
+  is.seekg(indexOffset);
+  index.resize(blockN);
+  for (uint64_t i= 0; i < blockN; i++) {
+    index[i].offset= getRaw<uint64_t>(is);
+    index[i].step0= getRaw<uint64_t>(is);
+    index[i].spikeN= getRaw<uint64_t>(is);
+    index[i].byteN= getRaw<uint64_t>(is);
+  }
+  neuronOffset.clear();
+  neuronBlob.clear();
+  if (neuronIndexOffset > 0) {
+    neuronOffset.resize(neuronN+1);
+    for (unsigned int i= 0; i <= neuronN; i++) neuronOffset[i]= getRaw<uint64_t>(is);
+    uint64_t blobN= fileEnd-40-(neuronIndexOffset+8*(neuronN+1));
+    neuronBlob.resize(blobN+1);
+    if (blobN > 0) is.read((char *) &neuronBlob[0], blobN);
+  }
+  return is.good();
+}
+
+// decode block b into out; only neuron id if id >= 0
+void spikeReader::readBlock(unsigned int b, vector<spike_t> &out, int id)
+{
+  const spikeBlock_t &B= index[b];
+  vector<unsigned char> buf(B.byteN);
+  is.seekg(B.offset);
+  is.read((char *) &buf[0], B.byteN);
+  const unsigned char *p= &buf[0], *end= p+B.byteN;
+  uint64_t step= B.step0;
+  spike_t s;
+  while (p < end) {
+    step+= getVarint(p);
+    s.t= step*dt;
+    uint64_t n= getVarint(p);
+    s.id= 0;
+    for (uint64_t i= 0; i < n; i++) {
+      s.id+= getVarint(p);
+      if ((id < 0) || (s.id == (unsigned int) id)) out.push_back(s);
+    }
+  }
+}
+
+void spikeReader::readAll(vector<spike_t> &out)
+{
+  out.clear();
+  out.reserve(spikeN);
+  for (unsigned int b= 0; b < index.size(); b++) readBlock(b, out);
+}
+
+// all spikes with t0 <= t < t1; finds the blocks with the index
+void spikeReader::readRange(double t0, double t1, vector<spike_t> &out)
+{
+  out.clear();
+  uint64_t s0= (t0 > 0.0) ? (uint64_t) floor(t0/dt+0.5) : 0;
+  unsigned int b= 0;
+  while ((b < index.size()) && (index[b].step0+blockSteps <= s0)) b++;
+  vector<spike_t> tmp;
+  for (; (b < index.size()) && (index[b].step0*dt < t1); b++) {
+    tmp.clear();
+    readBlock(b, tmp);
+    for (unsigned int i= 0; i < tmp.size(); i++) {
+      if ((tmp[i].t >= t0) && (tmp[i].t < t1)) out.push_back(tmp[i]);
+    }
+  }
+}
+
+// spike times of one neuron; reads only the blocks listed in the neuron index
+void spikeReader::readNeuron(unsigned int id, vector<double> &times)
+{
+  times.clear();
+  vector<spike_t> tmp;
+  if (neuronOffset.empty()) {
+    for (unsigned int b= 0; b < index.size(); b++) readBlock(b, tmp, id);
+  }
+  else {
+    const unsigned char *p= &neuronBlob[neuronOffset[id]];
+    uint64_t n= getVarint(p), b= 0;
+    for (uint64_t i= 0; i < n; i++) {
+      b+= getVarint(p);
+      readBlock(b, tmp, id);
+    }
+  }
+  for (unsigned int i= 0; i < tmp.size(); i++) times.push_back(tmp[i].t);
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+
+  Binary spike train files (.out.stb), the compact alternative to the "t id"
+  text lines of .out.st.
+
+  Layout (numbers in the byte order of the machine, little endian on x86):
+  header   "ALSPK001", uint32 neuronN, uint32 blockSteps, double dt
+  blocks   for every step with spikes: varint step - previous step (the
+           first relative to the first step of the block), varint number of
+           spikes, varint first id, varint id differences (ids ascending)
+  index    per non-empty block: uint64 offset, uint64 first step,
+           uint64 spikes, uint64 bytes
+  neurons  optional: uint64 offsets[neuronN+1] into a blob that holds per
+           neuron varint number of blocks, varint block number differences
+  trailer  uint64 index offset, uint64 blocks, uint64 neuron index offset
+           (0: none), uint64 spikes, "ALSPKEND"
+
+  A step s stands for the time s*dt. Block b holds the steps
+  [b*blockSteps, (b+1)*blockSteps); only blocks with spikes are stored.
+
+--------------------------------------------------------------------------*/
+
+#ifndef SPIKEIO_H
+#define SPIKEIO_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+#define SPIKEIO_MAGIC "ALSPK001"
+#define SPIKEIO_END "ALSPKEND"
+
+struct spike_t {
+  double t;
+  unsigned int id;
+};
+
+struct spikeBlock_t {
+  uint64_t offset, step0, spikeN, byteN;
+};
+
+class spikeWriter
+{
+ private:
+  ofstream os;
+  unsigned int neuronN;
+  unsigned int blockSteps;
+  double dt;
+  bool neuronIndex;
+  uint64_t block, lastStep, spikeN, blockSpikeN;
+  vector<unsigned char> buf;
+  vector<unsigned int> ids;
+  vector<spikeBlock_t> index;
+  vector<vector<uint64_t> > neuronBlocks;
+
+  void flushBlock();
+
+ public:
+  spikeWriter();
+  ~spikeWriter();
+  void open(string, unsigned int, double, unsigned int blockSteps= 5000, bool neuronIndex= true);
+  bool is_open() { return os.is_open(); }
+  void write(double, const unsigned int *, unsigned int);
+  void close();
+};
+
+class spikeReader
+{
+ private:
+  ifstream is;
+  uint64_t spikeN;
+  vector<spikeBlock_t> index;
+  vector<uint64_t> neuronOffset;
+  vector<unsigned char> neuronBlob;
+
+  void readBlock(unsigned int, vector<spike_t> &, int id= -1);
+
+ public:
+  unsigned int neuronN;
+  unsigned int blockSteps;
+  double dt;
+
+  bool open(string);
+  uint64_t spikes() { return spikeN; }
+  unsigned int blocks() { return index.size(); }
+  bool hasNeuronIndex() { return !neuronOffset.empty(); }
+  void readAll(vector<spike_t> &);
+  void readRange(double, double, vector<spike_t> &);
+  void readNeuron(unsigned int, vector<double> &);
+};
+
+#endif
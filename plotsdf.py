@@ -9,6 +9,8 @@ import matplotlib.pyplot as plt
 import numpy as np
 from matplotlib import rcParams
 import sys
+import os
+import struct
 
 colors= ['r', 'g', 'b', 'y','k','c','m','orange','violet','teal','brown','grey','olive','palegreen','pink','purple']
 
@@ -53,18 +55,29 @@ rcParams.update(params)
 nAL=150
 inglom = 5 #also 1 interneuron from LN
 
-sdffile=open('sdffile')#this is the file created by tools/st2asdf_mult
-
-sdfarray = []
-	
-for line in sdffile.readlines():
-	a=line.split(" ")
-	pt = []
-	for k in range(len(a)-1):
-		pt.append(a[k]) # #neurons
-	sdfarray.append(pt)
-
-sdfnp=np.array(sdfarray,dtype=float)
+def load_matrix(name):
+	'''rows "t value value ..." of a text file, or of a binary matrix file
+	(.sdfb, .out.cmpb, see model/include/matbin), which is mapped into memory'''
+	f=open(name,'rb')
+	head=f.read(64)
+	f.close()
+	if (head[:8] == b'ALMAT001'):
+		magic,vbytes,cols,rows,t0,dt,names,namesbytes,data=struct.unpack('<8sIIQddQQQ',head)
+		if (rows == 0): # not closed, the rows that are there
+			rows=(os.path.getsize(name)-data)//(cols*vbytes)
+		return np.memmap(name,dtype=('<f8' if vbytes == 8 else '<f4'),mode='r',offset=data,shape=(rows,cols))
+	array = []
+	for line in open(name).readlines():
+		a=line.split(" ")
+		pt = []
+		for k in range(len(a)-1):
+			pt.append(a[k]) # #neurons
+		array.append(pt)
+	return np.array(array,dtype=float)
+
+sdffile='sdffile'#this is the file created by tools/st2asdf_mult (text or -b binary) or ALsim (.sdf/.sdfb)
+
+sdfnp=np.array(load_matrix(sdffile),dtype=float)
 sdfnp[:,0]=sdfnp[:,0]/1000
 sdfnp[:,1:]=sdfnp[:,1:]*1000
 
@@ -152,19 +165,9 @@ ax.set_ylim(-1.5, 12)
 ax.set_xlim(xmin, xmax)
 print('xmax 1: ',xmax)
 ##############################
-cmpfile=open('cmpfile')#this is the outputfile (outname/outname.out.cmp)
-
-cmparray = []
-	
-for line in cmpfile.readlines():
-	a=line.split(" ")
-	pt = []
-	for k in range(len(a)-1):
-		pt.append(a[k]) # #neurons
-	cmparray.append(pt)
-
+cmpfile='cmpfile'#this is the outputfile (outname/outname.out.cmp or .out.cmpb)
 
-cmpnp=np.array(cmparray,dtype=float)
+cmpnp=np.array(load_matrix(cmpfile),dtype=float)
 cmpnp[:,0]=cmpnp[:,0]/1000
 
 xmin=0
@@ -0,0 +1,249 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+   Contributed by: Esin Yavuz
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+
+//--------------------------------------------------------------------------
+/*! \file sweep.cc
+
+\brief Parameter sweeps with the CPU build of ALsim, which reads its .in
+file at runtime and so is built once for all runs.
+
+The sweep file has lines of
+\verbatim
+outdir <directory>         where the runs go (default sweep_out)
+in <file>                  base .in file (default example.in)
+proto <file>               protocol (default similar.proto)
+sim <executable>           (default model/ALsim)
+jobs <n>                   runs at the same time (default 0: one per core)
+grid <AP name> <values>    all combinations with the other grid parameters
+list <AP name> <values>    all list parameters step together
+\endverbatim
+and '#' comments. The runs are all combinations of the grid values times
+the rows of the lists. Run i goes to <outdir>/runNNNN with ALmodel.in (the
+base file with the overrides appended, which read_AP takes last),
+ALmodel.proto and the ALsim log ALmodel.log. <outdir>/manifest.tsv lists
+each run with its parameter values, exit status and wall clock time.
+*/
+//--------------------------------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// destructors out of line: -Winline warns when the implicit ones are not inlined
+struct sweepParam {
+  string name;
+  vector<string> values;
+  ~sweepParam();
+};
+
+sweepParam::~sweepParam()
+{
+}
+
+struct sweepRun {
+  string dir;
+  vector<string> values; //!< one per parameter, grid parameters first
+  int status;
+  double seconds;
+  ~sweepRun();
+};
+
+sweepRun::~sweepRun()
+{
+}
+
+double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec+1e-6*tv.tv_usec;
+}
+
+string readFile(string name)
+{
+  ifstream is(name.c_str());
+  if (!is.good()) {
+    cerr << "cannot read " << name << " ... exiting" << endl;
+    exit(1);
+  }
+  stringstream s;
+  s << is.rdbuf();
+  return s.str();
+}
+
+//! start ALsim on run r; stdout and stderr go to its log
+pid_t startRun(string sim, sweepRun &r)
+{
+  pid_t pid= fork();
+  if (pid < 0) {
+    cerr << "fork failed ... exiting" << endl;
+    exit(1);
+  }
+  if (pid == 0) {
+    string log= r.dir+"/ALmodel.log";
+    int fd= open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      dup2(fd, 1);
+      dup2(fd, 2);
+      close(fd);
+    }
+    execl(sim.c_str(), sim.c_str(), r.dir.c_str(), "ALmodel", "0", (char *) NULL);
+    cerr << "cannot execute " << sim << endl;
+    _exit(127);
+  }
+  return pid;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc != 2) {
+    cerr << "usage: sweep <sweep file>" << endl;
+    exit(1);
+  }
+  string outdir= "sweep_out", inName= "example.in", protoName= "similar.proto", sim= "model/ALsim";
+  int jobs= 0;
+  vector<sweepParam> grid, list;
+
+  ifstream is(argv[1]);
+  if (!is.good()) {
+    cerr << "cannot read sweep file " << argv[1] << " ... exiting" << endl;
+    exit(1);
+  }
+  string line;
+  while (getline(is, line)) {
+    stringstream s(line);
+    string key;
+    if (!(s >> key) || (key[0] == '#')) continue;
+    if (key == "outdir") s >> outdir;
+    else if (key == "in") s >> inName;
+    else if (key == "proto") s >> protoName;
+    else if (key == "sim") s >> sim;
+    else if (key == "jobs") s >> jobs;
+    else if ((key == "grid") || (key == "list")) {
+      sweepParam p;
+      string v;
+      s >> p.name;
+      while (s >> v) p.values.push_back(v);
+      if (p.values.empty()) {
+	cerr << "no values for " << p.name << " ... exiting" << endl;
+	exit(1);
+      }
+      if (key == "grid") grid.push_back(p);
+      else list.push_back(p);
+    }
+    else {
+      cerr << "unknown sweep file entry " << key << " ... exiting" << endl;
+      exit(1);
+    }
+  }
+  unsigned int rows= 1;
+  for (unsigned int i= 0; i < list.size(); i++) {
+    if ((i > 0) && (list[i].values.size() != rows)) {
+      cerr << "list " << list[i].name << " has " << list[i].values.size() << " values, expected " << rows << " ... exiting" << endl;
+      exit(1);
+    }
+    rows= list[i].values.size();
+  }
+  if (access(sim.c_str(), X_OK) != 0) {
+    cerr << sim << " not found, build it first with \"cd model && make CPU_ONLY=1\" ... exiting" << endl;
+    exit(1);
+  }
+  if (jobs <= 0) jobs= sysconf(_SC_NPROCESSORS_ONLN);
+  if (jobs <= 0) jobs= 1;
+
+  // all combinations, the last grid parameter fastest, then the list rows
+  vector<sweepParam> params(grid);
+  params.insert(params.end(), list.begin(), list.end());
+  unsigned int runN= rows;
+  for (unsigned int i= 0; i < grid.size(); i++) runN*= grid[i].values.size();
+  string base= readFile(inName), proto= readFile(protoName);
+  mkdir(outdir.c_str(), 0755);
+  vector<sweepRun> runs(runN);
+  for (unsigned int n= 0; n < runN; n++) {
+    sweepRun &r= runs[n];
+    unsigned int rest= n;
+    unsigned int row= rest % rows;
+    rest/= rows;
+    r.values.resize(params.size());
+    for (int i= grid.size()-1; i >= 0; i--) {
+      r.values[i]= grid[i].values[rest % grid[i].values.size()];
+      rest/= grid[i].values.size();
+    }
+    for (unsigned int i= 0; i < list.size(); i++) r.values[grid.size()+i]= list[i].values[row];
+    char num[16];
+    sprintf(num, "/run%04u", n);
+    r.dir= outdir+num;
+    r.status= -1;
+    r.seconds= 0.0;
+    mkdir(r.dir.c_str(), 0755);
+    ofstream os((r.dir+"/ALmodel.in").c_str());
+    os << base << endl;
+    for (unsigned int i= 0; i < params.size(); i++) os << params[i].name << " " << r.values[i] << endl;
+    os.close();
+    ofstream ps((r.dir+"/ALmodel.proto").c_str());
+    ps << proto;
+    ps.close();
+  }
+
+  cerr << "% " << runN << " runs in " << outdir << ", " << jobs << " at a time" << endl;
+  map<pid_t, unsigned int> running;
+  map<pid_t, double> started;
+  unsigned int next= 0, failed= 0;
+  double t0= wallTime();
+  while ((next < runN) || !running.empty()) {
+    if ((next < runN) && ((int) running.size() < jobs)) {
+      pid_t pid= startRun(sim, runs[next]);
+      running[pid]= next++;
+      started[pid]= wallTime();
+      continue;
+    }
+    int status;
+    pid_t pid= wait(&status);
+    if (pid < 0) break;
+    if (running.find(pid) == running.end()) continue;
+    sweepRun &r= runs[running[pid]];
+    r.status= WIFEXITED(status) ? WEXITSTATUS(status) : 128+WTERMSIG(status);
+    r.seconds= wallTime()-started[pid];
+    if (r.status != 0) failed++;
+    cerr << "% " << r.dir << ": " << ((r.status == 0) ? "done" : "FAILED") << " after " << r.seconds << " s" << endl;
+    running.erase(pid);
+    started.erase(pid);
+  }
+
+  ofstream ms((outdir+"/manifest.tsv").c_str());
+  ms << "run\tdirectory";
+  for (unsigned int i= 0; i < params.size(); i++) ms << "\t" << params[i].name;
+  ms << "\tstatus\tseconds" << endl;
+  for (unsigned int n= 0; n < runN; n++) {
+    ms << n << "\t" << runs[n].dir;
+    for (unsigned int i= 0; i < params.size(); i++) ms << "\t" << runs[n].values[i];
+    ms << "\t" << runs[n].status << "\t" << runs[n].seconds << endl;
+  }
+  ms.close();
+  cerr << "% sweep done in " << wallTime()-t0 << " s, " << failed << " of " << runN << " runs failed; manifest in " << outdir << "/manifest.tsv" << endl;
+  return (failed > 0) ? 1 : 0;
+}
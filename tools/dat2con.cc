@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+//example usage:
+//dat2con ../model/inhibition.dat inhibition.con       (the glomerular matrix hLNPN, for LNPNsynFile)
+//dat2con matrix.dat matrix.con myName               (under another name)
+//dat2con -l network.con                            (list the entries of a connectivity file)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include "conbin.cc"
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+  if ((argc == 3) && (string(argv[1]) == "-l")) {
+    conFile f;
+    if (!f.open(argv[2])) {
+      cerr << "could not read connectivity file " << argv[2] << endl;
+      exit(1);
+    }
+    for (unsigned int i= 0; i < f.entries(); i++) {
+      const conEntry *e= f.entry(i);
+      cout << e->name << ": " << ((e->kind == CONBIN_DENSE) ? "dense " : "CSR ") << e->rows << " x " << e->cols << ", " << e->nnz << " values of " << e->valueBytes << " bytes";
+      if ((e->kind == CONBIN_CSR) && !f.checkCSR(e)) cout << " (invalid)";
+      cout << endl;
+    }
+    return 0;
+  }
+  if ((argc < 3) || (argc > 4)) {
+    cerr << "usage: dat2con <matrix.dat> <out.con> [<name>]" << endl;
+    cerr << "       dat2con -l <file.con>" << endl;
+    exit(1);
+  }
+  string name= (argc > 3) ? argv[3] : "hLNPN";
+  ifstream is(argv[1]);
+  if (!is.good()) {
+    cerr << "could not read " << argv[1] << endl;
+    exit(1);
+  }
+  // one matrix row per line
+  vector<double> g;
+  unsigned int rows= 0, cols= 0;
+  string line;
+  while (getline(is, line)) {
+    stringstream s(line);
+    double x;
+    unsigned int n= 0;
+    while (s >> x) {
+      g.push_back(x);
+      n++;
+    }
+    if (n == 0) continue;
+    if ((rows > 0) && (n != cols)) {
+      cerr << argv[1] << ": row " << rows << " has " << n << " values, expected " << cols << " ... exiting" << endl;
+      exit(1);
+    }
+    cols= n;
+    rows++;
+  }
+  conWriter w;
+  w.addDense(name, rows, cols, &g[0]);
+  if (!w.write(argv[2])) {
+    cerr << "could not write " << argv[2] << endl;
+    exit(1);
+  }
+  cerr << argv[2] << ": " << name << ", " << rows << " x " << cols << endl;
+  return 0;
+}
@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+//example usage:
+//odor2odb ../odors_slow ../odors_slow.odb              (odor0.para, odor1.para, ... with 30 glomeruli)
+//odor2odb ../odors_slow ../odors_slow.odb .para 30
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include "odorbank.cc"
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+  if ((argc < 3) || (argc > 5)) {
+    cerr << "usage: odor2odb <odor directory> <bank.odb> [<extension> [<glomeruli>]]" << endl;
+    exit(1);
+  }
+  string ext= (argc > 3) ? argv[3] : ".para";
+  unsigned int gloN= (argc > 4) ? atoi(argv[4]) : 30;
+  unsigned int paraN= 5;
+  vector<double> pp;
+  unsigned int odorN= 0;
+  while (1) {
+    stringstream name;
+    name << argv[1] << "/odor" << odorN << ext;
+    ifstream is(name.str().c_str());
+    if (!is.good()) break;
+    is.close();
+    pp.resize((odorN+1)*gloN*paraN);
+    if (!readOdorFile(name.str(), gloN, paraN, &pp[odorN*gloN*paraN])) {
+      cerr << name.str() << " has fewer than " << gloN << " lines of " << paraN << " numbers ... exiting" << endl;
+      exit(1);
+    }
+    odorN++;
+  }
+  if (odorN == 0) {
+    cerr << "no odor files " << argv[1] << "/odor<i>" << ext << " found ... exiting" << endl;
+    exit(1);
+  }
+  if (!writeOdorBank(argv[2], odorN, gloN, paraN, pp)) {
+    cerr << "could not write " << argv[2] << " ... exiting" << endl;
+    exit(1);
+  }
+  // read it back
+  odorBank bank;
+  if (!bank.open(argv[2]) || (bank.odorN != odorN)) {
+    cerr << "could not read back " << argv[2] << " ... exiting" << endl;
+    exit(1);
+  }
+  for (unsigned int i= 0; i < odorN; i++) {
+    const double *o= bank.odor(i);
+    for (unsigned int j= 0; j < gloN*paraN; j++) {
+      if (o[j] != pp[i*gloN*paraN+j]) {
+	cerr << "odor " << i << " differs in " << argv[2] << " ... exiting" << endl;
+	exit(1);
+      }
+    }
+  }
+  cerr << argv[2] << ": " << odorN << " odors of " << gloN << " glomeruli x " << paraN << " parameters, " << bank.odorStride << " bytes per odor" << endl;
+  return 0;
+}
@@ -1,152 +1,480 @@
 /*--------------------------------------------------------------------------
    Author: Thomas Nowotny
-  
+
    Institute: Institute for Nonlinear Dynamics
               University of California San Diego
               La Jolla, CA 92093-0402
-  
+
    email to:  tnowotny@ucsd.edu
-  
+
    initial version: 2002-01-25
-  
+
 --------------------------------------------------------------------------*/
 //example usage:
-//st2asdf_mult ALmodel.out.st 50 20 ALmodel.sdf <sim. time> <# neurons>
+//st2asdf_mult ALmodel.out.st 50 20 ALmodel.sdf <sim. time> <# neurons> [alpha|exp|gauss]
+//st2asdf_mult -m 50 20 <sim. time> <# neurons> alpha sweep_out/run*/ALmodel.out.st
+//   (writes sweep_out/runNNNN/ALmodel.out.sdf for each of them)
+//options before the arguments:
+//   -j <n>  threads (default 0: one per core)
+//   -c <n>  output rows held in memory per file (default 2048, 0: all)
+//   -b <n>  write a binary matrix file (model/include/matbin) with values
+//           of n bytes (4: float, 8: double) instead of text; with -m it
+//           is called <name>.sdfb
+
+// The spikes of each neuron are counted in bins of dt_SDF once, and the
+// counts are then filtered recursively, so the cost is linear in the
+// number of output samples:
+// alpha  t*exp(-t/tau) shifted by tau (the default, as Kroczik et al. 2009),
+//        the sampled kernel j*dt*q^j with q= exp(-dt/tau) is a cascade of
+//        two first order filters, x[i]= q x[i-1]+c[i], y[i]= q (y[i-1]+x[i-1])
+// exp    exp(-t/tau), y[i]= q y[i-1]+c[i]
+// gauss  Gaussian of width tau, approximated by four centred box filters
+//        (running sums, y[i]= y[i-1]+c[i+h]-c[i-h-1]) of the width that
+//        gives the nearest variance; kept in integers, so exact
+// The spike file (in time order, as ALsim writes it) is read in chunks of
+// rows; the filter state of each neuron is carried from one chunk to the
+// next (the Gaussian keeps and looks ahead by its half width), and each chunk is
+// filtered and formatted on all threads and then written. Several files
+// are worked on at the same time.
 
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
 #include <sstream>
+#include <string>
+#include <vector>
 #include <cmath>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include "matbin.cc"
 using namespace std;
 
+enum { KRNL_ALPHA, KRNL_EXP, KRNL_GAUSS };
+
+int krnlType= KRNL_ALPHA;
 double tau_SDF;
 double norm= 0.0;
 double dt_SDF= 0.1;
 int SDFSz;
-int krnlStpN;
+int leadN, trailN; // bins before time 0 and after tmax that the kernel reaches into the output
 double krnlShft;
-double eps_KRNL= 0.01;
+double q;
+#define BOX_PASSES 4
+int boxH; // box filters of width 2 boxH+1 for the Gaussian
+double boxNorm; // (2 boxH+1)^BOX_PASSES
+int nNo;
+int chunkRows= 2048;
+int binBytes= 0; // > 0: binary output
 
 #define PI 3.1415927
 
-void kernel_Prep() 
+void kernel_Prep()
 {
-  double sum= 0.0;
-  double tsm= 0.0;
-  double krnl= 0.0;
-  double t;
+  q= exp(-dt_SDF/tau_SDF);
+  trailN= 0;
+  if (krnlType == KRNL_ALPHA) {
+    // dt sum_j j dt q^j, the integral
+    norm= dt_SDF*dt_SDF*q/((1.0-q)*(1.0-q));
+    krnlShft= tau_SDF;
+  }
+  else if (krnlType == KRNL_EXP) {
+    norm= dt_SDF/(1.0-q);
+    krnlShft= 0.0;
+  }
+  else {
+    // variance of BOX_PASSES boxes of width w: BOX_PASSES (w^2-1)/12
+    double s= tau_SDF/dt_SDF;
+    if (s < 1.0) {
+      cerr << "the Gaussian width must be at least dt_SDF ... exiting" << endl;
+      exit(1);
+    }
+    double w= sqrt(12.0*s*s/BOX_PASSES+1.0);
+    boxH= (int) floor((w-1.0)/2.0+0.5);
+    if (boxH < 1) boxH= 1;
+    boxNorm= pow(2.0*boxH+1.0, BOX_PASSES);
+    if (boxNorm > 1e12) {
+      cerr << "the Gaussian is too wide for dt_SDF ... exiting" << endl;
+      exit(1);
+    }
+    cerr << "# Gaussian of width " << sqrt(BOX_PASSES*((2.0*boxH+1.0)*(2.0*boxH+1.0)-1.0)/12.0)*dt_SDF << endl;
+    norm= dt_SDF*boxNorm;
+    krnlShft= 0.0;
+    trailN= BOX_PASSES*boxH;
+  }
+  leadN= (int) ceil(krnlShft/dt_SDF)+1;
+  if (krnlType == KRNL_GAUSS) leadN= trailN;
+  cerr << krnlShft << endl;
+}
+
+// the bin of a spike at tme, counting from leadN bins before time 0
+int spike_bin(double tme)
+{
+  double u= (tme-krnlShft)/dt_SDF;
+  int iTime= (krnlType == KRNL_GAUSS) ? (int) floor(u+0.5) : (int) floor(u);
+  return iTime+leadN;
+}
 
-  int i= 0;
-  int mxp= (int) (tau_SDF/dt_SDF);
-  while ((i < mxp) || (krnl > eps_KRNL)) {
-    t= i*dt_SDF;
-    krnl= t*exp(-t/tau_SDF);
-    sum+= krnl;
-    tsm+= t*krnl;
-    i++;
-  }
-  krnlStpN= i;
-  norm= sum*dt_SDF; // this is the integral
-  // krnlShft= tsm/sum;  // this aims for centering on the center of mass
-  krnlShft= tau_SDF; 
-   cerr << krnlShft << endl;
-}  
-
-  
-void blank_SDF(double **sdf, int cols, int sz)
+//--------------------------------------------------------------------------
+/*! filter state of a neuron, carried from one chunk to the next */
+//--------------------------------------------------------------------------
+
+struct sdfState {
+  double x, y; // alpha and exp
+  double sum;
+};
+
+//--------------------------------------------------------------------------
+/*! turn the counts c of a chunk of n bins into the (unnormalised) SDF out,
+  continuing from st; for the Gaussian c starts trailN bins before the
+  chunk and runs to trailN bins after it, and tmp has room for two copies
+ */
+//--------------------------------------------------------------------------
+
+void filter_SDF(const double *c, int n, sdfState &st, double *out, double *tmp)
 {
-  for (int k= 0; k < cols; k++) {
-    for (int i= 0; i < sz; i++) {
-      sdf[k][i]= 0.0;
+  if (krnlType == KRNL_ALPHA) {
+    double x= st.x, y= st.y;
+    for (int i= 0; i < n; i++) {
+      y= q*(y+x);
+      x= q*x+c[i];
+      out[i]= dt_SDF*y;
+    }
+    st.x= x;
+    st.y= y;
+  }
+  else if (krnlType == KRNL_EXP) {
+    double y= st.y;
+    for (int i= 0; i < n; i++) {
+      y= q*y+c[i];
+      out[i]= y;
     }
+    st.y= y;
   }
+  else {
+    int len= n+2*trailN;
+    const double *src= c;
+    double *dst= tmp;
+    int lo= 0, hi= len; // the valid part of src
+    for (int p= 0; p < BOX_PASSES; p++) {
+      double y= 0.0;
+      for (int i= lo; i < lo+2*boxH; i++) y+= src[i];
+      for (int i= lo+boxH; i < hi-boxH; i++) {
+	y+= src[i+boxH];
+	dst[i]= y;
+	y-= src[i-boxH];
+      }
+      lo+= boxH;
+      hi-= boxH;
+      src= dst;
+      dst= (dst == tmp) ? tmp+len : tmp;
+    }
+    for (int i= 0; i < n; i++) out[i]= src[trailN+i];
+  }
+}
+
+//--------------------------------------------------------------------------
+/*! reads "<t> <neuron>" pairs from a spike file through a large buffer */
+//--------------------------------------------------------------------------
+
+class stReader
+{
+ private:
+  FILE *f;
+  vector<char> buf;
+  size_t pos, end;
+  bool eof;
+
+  void fill() {
+    memmove(&buf[0], &buf[pos], end-pos);
+    end-= pos;
+    pos= 0;
+    size_t got= fread(&buf[end], 1, buf.size()-1-end, f);
+    if (got == 0) eof= true;
+    end+= got;
+    buf[end]= '\0';
+  }
+
+ public:
+  stReader(): f(NULL), buf(1 << 20), pos(0), end(0), eof(false) { buf[0]= '\0'; }
+  ~stReader() { if (f != NULL) fclose(f); }
+  bool open(string name) {
+    f= fopen(name.c_str(), "r");
+    return f != NULL;
+  }
+  bool next(double &t, int &id) {
+    if (!eof && (end-pos < 256)) fill();
+    char *p= &buf[pos], *e;
+    t= strtod(p, &e);
+    if (e == p) return false;
+    id= (int) strtol(e, &p, 10);
+    if (p == e) return false;
+    pos= p-&buf[0];
+    return true;
+  }
+};
+
+//--------------------------------------------------------------------------
+/*! run f(i, threadNo) for i in [0, n) on thrN threads */
+//--------------------------------------------------------------------------
+
+template<class F> void parallel_range(F *f, int n, int thrN, int k)
+{
+  for (int i= k*n/thrN; i < (k+1)*n/thrN; i++) (*f)(i, k);
+}
+
+template<class F> void parallel_for(int n, int thrN, F &f)
+{
+  if (thrN > n) thrN= n;
+  if (thrN <= 1) {
+    for (int i= 0; i < n; i++) f(i, 0);
+    return;
+  }
+  vector<thread> thr;
+  for (int k= 0; k < thrN; k++) thr.push_back(thread(parallel_range<F>, &f, n, thrN, k));
+  for (int k= 0; k < thrN; k++) thr[k].join();
 }
 
+struct filterChunk {
+  const vector<double> &cnt;
+  vector<sdfState> &st;
+  vector<double> &out;
+  vector<vector<double> > &tmp;
+  int stride, n, C;
+  void operator()(int k, int thr) {
+    filter_SDF(&cnt[(size_t) k*stride], n, st[k], &out[(size_t) k*C], &tmp[thr][0]);
+  }
+};
+
+struct formatChunk {
+  const vector<double> &out;
+  vector<string> &txt;
+  int b0, n, C, thrN;
+  void operator()(int part, int) {
+    char num[32];
+    string &s= txt[part];
+    s.clear();
+    for (int i= part*n/thrN; i < (part+1)*n/thrN; i++) {
+      int r= b0+i-leadN;
+      if ((r < 0) || (r >= SDFSz)) continue;
+      snprintf(num, 32, "%.10g ", r*dt_SDF);
+      s+= num;
+      for (int k= 0; k < nNo; k++) {
+	snprintf(num, 32, "%.10g ", out[(size_t) k*C+i]/norm);
+	s+= num;
+      }
+      s+= '\n';
+    }
+  }
+};
+
+//--------------------------------------------------------------------------
+/*! the SDF of spike file in is written to outfile, on thrN threads; returns
+  the integral of the SDF of each neuron in sum
+ */
+//--------------------------------------------------------------------------
 
-void add_to_SDF(double *sdf, double tme)
+void make_SDF(string in, string outfile, int thrN, vector<double> &sum)
 {
-  static double s, t, dt;
-  static int iTime;
-  
-  for (int j= 0; j < krnlStpN; j++) {
-    t= tme+j*dt_SDF-krnlShft;
-    dt= j*dt_SDF;
-    s= dt*exp(-dt/tau_SDF);
-    iTime= (int) (t/dt_SDF);
-    if ((iTime > 0) && (iTime < SDFSz)) {
-      sdf[iTime]+= s;
+  stReader is;
+  if (!is.open(in)) {
+    cerr << "cannot read " << in << " ... exiting" << endl;
+    exit(1);
+  }
+  ofstream os;
+  matWriter mw;
+  bool ok;
+  if (binBytes > 0) {
+    vector<string> col(1, "t");
+    for (int k= 0; k < nNo; k++) col.push_back(to_string(k));
+    ok= mw.open(outfile, col, binBytes, 0.0, dt_SDF);
+  }
+  else {
+    os.open(outfile.c_str());
+    ok= os.good();
+  }
+  if (!ok) {
+    cerr << "cannot write " << outfile << " ... exiting" << endl;
+    exit(1);
+  }
+  int total= leadN+SDFSz+trailN;
+  int C= (chunkRows > 0) ? min(chunkRows, total) : total;
+  int L= (krnlType == KRNL_GAUSS) ? trailN : 0; // bins kept before and read after the chunk
+  int stride= C+2*L;
+  vector<double> cnt((size_t) nNo*stride, 0.0), out((size_t) nNo*C);
+  vector<vector<double> > tmp(thrN, vector<double>(2*stride));
+  vector<sdfState> st(nNo);
+  memset(&st[0], 0, nNo*sizeof(sdfState));
+  vector<string> txt(thrN);
+  vector<double> row(nNo);
+  double t;
+  int spk, bin= -1;
+  bool have= is.next(t, spk);
+  if (have) bin= spike_bin(t);
+  for (int b0= 0; b0 < total; b0+= C) {
+    int n= min(C, total-b0);
+    while (have && (bin < b0+n+L)) {
+      if (bin < b0) {
+	if (bin >= 0) {
+	  cerr << in << ": spikes not in time order at t= " << t << " ... exiting" << endl;
+	  exit(1);
+	}
+      }
+      else if ((bin < total) && (spk >= 0) && (spk < nNo)) cnt[(size_t) spk*stride+L+bin-b0]+= 1.0;
+      have= is.next(t, spk);
+      if (have) bin= spike_bin(t);
+    }
+    filterChunk fc= { cnt, st, out, tmp, stride, n, C };
+    parallel_for(nNo, thrN, fc);
+    if (binBytes > 0) {
+      for (int i= 0; i < n; i++) {
+	int r= b0+i-leadN;
+	if ((r < 0) || (r >= SDFSz)) continue;
+	for (int k= 0; k < nNo; k++) row[k]= out[(size_t) k*C+i]/norm;
+	mw.row(r*dt_SDF, &row[0]);
+      }
     }
-  }    
+    else {
+      formatChunk ff= { out, txt, b0, n, C, thrN };
+      parallel_for(thrN, thrN, ff);
+      for (int k= 0; k < thrN; k++) os << txt[k];
+    }
+    for (int k= 0; k < nNo; k++) {
+      double *c= &cnt[(size_t) k*stride];
+      for (int i= 0; i < n; i++) {
+	int r= b0+i-leadN;
+	if ((r >= 0) && (r < SDFSz)) st[k].sum+= out[(size_t) k*C+i];
+      }
+      memmove(c, c+n, (stride-n)*sizeof(double));
+      memset(c+(stride-n), 0, n*sizeof(double));
+    }
+  }
+  if (binBytes > 0) mw.close();
+  else os.close();
+  sum.resize(nNo);
+  for (int k= 0; k < nNo; k++) sum[k]= st[k].sum;
+}
+
+// takes the next file until all are done
+struct fileWorker {
+  const vector<string> &in, &outfile;
+  vector<vector<double> > &sum;
+  atomic<int> &next;
+  int inner;
+  void operator()() {
+    int f, fileN= in.size();
+    while ((f= next++) < fileN) {
+      make_SDF(in[f], outfile[f], inner, sum[f]);
+      if (fileN > 1) cerr << "% " << outfile[f] << endl;
+    }
+  }
+};
+
+// <dir>/<base>.st -> <dir>/<base>.sdf (.sdfb), else <name>.sdf (.sdfb)
+string sdf_name(string in)
+{
+  size_t n= in.size();
+  string ext= (binBytes > 0) ? ".sdfb" : ".sdf";
+  if ((n > 3) && (in.compare(n-3, 3, ".st") == 0)) return in.substr(0, n-3)+ext;
+  return in+ext;
+}
+
+void usage()
+{
+  cerr << "usage: st2sdf [-j <threads>] [-c <chunk rows>] [-b <4|8>] <infile> <tau_SDF> <dt_SDF> <outfile> <tmax> <neuron no> [alpha|exp|gauss]" << endl;
+  cerr << "       st2sdf [-j <threads>] [-c <chunk rows>] [-b <4|8>] -m <tau_SDF> <dt_SDF> <tmax> <neuron no> <alpha|exp|gauss> <infile> ..." << endl;
+  exit(1);
 }
 
 int main(int argc, char *argv[])
 {
   // this tool makes an asymmetric SDF as used by Kroczik et al. 2009
-  // this is done with a t*exp(-t/tau) kernel shifted by tshift= centre 
+  // this is done with a t*exp(-t/tau) kernel shifted by tshift= centre
   // of mass of the kernel.
 
-  if (argc != 7) {
-    cerr << "usage: st2sdf <infile> <tau_SDF> <dt_SDF> <outfile> <tmax> <neuron no>" << endl;
-    exit(1);
-  }
-
   cerr << "# call was: ";
   for (int i= 0; i < argc; i++) {
     cerr << argv[i] << " ";
   }
   cerr << endl;
 
-  ifstream is(argv[1]);
-  ofstream os(argv[4]);
-  tau_SDF= atof(argv[2]);
-  dt_SDF= atof(argv[3]);
-  double tmax= atof(argv[5]);
-  int nNo= atoi(argv[6]);
-  
-  double **sdf= new double*[nNo];
-  double *sum= new double[nNo];
-  SDFSz= (int) (tmax/dt_SDF);
-  for (int k= 0; k < nNo; k++) {
-    sdf[k]= new double[SDFSz];
-    sum[k]= 0.0;
-    for (int l= 0; l < SDFSz; l++) {
-      sdf[k][l]= 0.0;
+  int thrN= 0;
+  bool multi= false;
+  int a= 1;
+  while ((a < argc) && (argv[a][0] == '-') && (argv[a][1] != '\0') && !isdigit(argv[a][1])) {
+    string o= argv[a++];
+    if (o == "-m") multi= true;
+    else if ((o == "-j") && (a < argc)) thrN= atoi(argv[a++]);
+    else if ((o == "-c") && (a < argc)) chunkRows= atoi(argv[a++]);
+    else if ((o == "-b") && (a < argc)) {
+      binBytes= atoi(argv[a++]);
+      if ((binBytes != 4) && (binBytes != 8)) usage();
+    }
+    else usage();
+  }
+  vector<string> in, outfile;
+  string kernel= "alpha";
+  double tmax;
+  if (multi) {
+    if (argc-a < 6) usage();
+    tau_SDF= atof(argv[a]);
+    dt_SDF= atof(argv[a+1]);
+    tmax= atof(argv[a+2]);
+    nNo= atoi(argv[a+3]);
+    kernel= argv[a+4];
+    for (int i= a+5; i < argc; i++) {
+      in.push_back(argv[i]);
+      outfile.push_back(sdf_name(argv[i]));
     }
   }
+  else {
+    if ((argc-a != 6) && (argc-a != 7)) usage();
+    in.push_back(argv[a]);
+    tau_SDF= atof(argv[a+1]);
+    dt_SDF= atof(argv[a+2]);
+    outfile.push_back(argv[a+3]);
+    tmax= atof(argv[a+4]);
+    nNo= atoi(argv[a+5]);
+    if (argc-a == 7) kernel= argv[a+6];
+  }
+  if (kernel == "alpha") krnlType= KRNL_ALPHA;
+  else if (kernel == "exp") krnlType= KRNL_EXP;
+  else if (kernel == "gauss") krnlType= KRNL_GAUSS;
+  else {
+    cerr << "unknown kernel " << kernel << " ... exiting" << endl;
+    exit(1);
+  }
+  if ((tau_SDF <= 0.0) || (dt_SDF <= 0.0) || (nNo <= 0)) {
+    cerr << "tau_SDF, dt_SDF and the neuron number must be positive ... exiting" << endl;
+    exit(1);
+  }
+  if (thrN <= 0) thrN= sysconf(_SC_NPROCESSORS_ONLN);
+  if (thrN <= 0) thrN= 1;
 
+  SDFSz= 0;
+  while (SDFSz*dt_SDF < tmax) SDFSz++;
   kernel_Prep();
-  double t;
-  int spk;
 
-  os.precision(10);
+  // the files on workN workers, the threads shared out between them
+  int fileN= in.size();
+  int workN= min(thrN, fileN);
+  int inner= max(1, thrN/max(workN, 1));
+  vector<vector<double> > sum(fileN);
+  atomic<int> next(0);
+  fileWorker fw= { in, outfile, sum, next, inner };
+  vector<thread> work;
+  for (int w= 0; w < workN; w++) work.push_back(thread(fw));
+  for (int w= 0; w < workN; w++) work[w].join();
 
-  is >> t;
-  blank_SDF(sdf, nNo, SDFSz);
-  while (is.good()) {
-    is >> spk;
-    add_to_SDF(sdf[spk], t);
-    is >> t;
-  }
-  int i= 0;
-  double sdft= i*dt_SDF;
-  while (sdft < tmax) {
-    os << sdft << " ";
+  if (fileN == 1) {
     for (int k= 0; k < nNo; k++) {
-      os << sdf[k][i]/norm << " ";
-      sum[k]+= sdf[k][i];
+      cerr << sum[0][k]/norm*dt_SDF << " ";
     }
-    os << endl;
-    i++;
-    sdft= i*dt_SDF;
+    cerr << endl;
   }
 
-  for (int k= 0; k < nNo; k++) {
-    cerr << sum[k]/norm*dt_SDF << " ";
-  }
-  cerr << endl;
-
   return 0;
 }
-
-
@@ -0,0 +1,52 @@
+/*--------------------------------------------------------------------------
+   Author: Thomas Nowotny
+
+   Institute: Center for Computational Neuroscience and Robotics
+              University of Sussex
+              Falmer, Brighton BN1 9QJ, UK
+
+   email to:  T.Nowotny@sussex.ac.uk
+
+   initial version: 2026-10-17
+
+--------------------------------------------------------------------------*/
+//example usage:
+//stb2st ALmodel.out.stb ALmodel.out.st
+//stb2st ALmodel.out.stb PN3.st 3        (spike times of neuron 3 only)
+//stb2st ALmodel.out.stb part.st 1000 2000  (spikes with 1000 <= t < 2000)
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include "spikeio.cc"
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+  if ((argc < 3) || (argc > 5)) {
+    cerr << "usage: stb2st <infile.stb> <outfile.st> [<neuron no> | <t0> <t1>]" << endl;
+    exit(1);
+  }
+  spikeReader r;
+  if (!r.open(argv[1])) {
+    cerr << "could not read binary spike file " << argv[1] << endl;
+    exit(1);
+  }
+  cerr << argv[1] << ": " << r.neuronN << " neurons, " << r.spikes() << " spikes in " << r.blocks() << " blocks, dt= " << r.dt << endl;
+  ofstream os(argv[2]);
+  os.precision(5);
+  if (argc == 4) {
+    unsigned int id= atoi(argv[3]);
+    vector<double> st;
+    r.readNeuron(id, st);
+    for (unsigned int i= 0; i < st.size(); i++) os << st[i] << " " << id << '\n';
+  }
+  else {
+    vector<spike_t> sp;
+    if (argc == 5) r.readRange(atof(argv[3]), atof(argv[4]), sp);
+    else r.readAll(sp);
+    for (unsigned int i= 0; i < sp.size(); i++) os << sp[i].t << " " << sp[i].id << '\n';
+  }
+  os.close();
+  return 0;
+}